@@ -0,0 +1,25 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete of dsn_bench to count the allocations,
+// the array, sized and nothrow forms all end up here.
+
+std::atomic<uint64_t> g_heapAllocations{ 0 };
+
+void *operator new(std::size_t size) {
+	g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	void *p = std::malloc(size ? size : 1);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+	std::free(p);
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Number of heap allocations (operator new) made by the benchmark process, see AllocationCounter.cpp
+extern std::atomic<uint64_t> g_heapAllocations;
@@ -0,0 +1,32 @@
+#include "CommandDebouncer.h"
+#include "FakePlatform.h"
+#include <benchmark/benchmark.h>
+
+// The check done for every line received from the service. Arg: 0 for distinct commands,
+// 1 for every command reported twice (the second report is suppressed).
+static void BM_CommandDebouncer(benchmark::State &state) {
+	static const char *lines[] = {
+		"COMMAND|player.cast 0003f9ed player voice|0|12",
+		"COMMAND|press leftmousebutton 1000;sleep 500;tapkey r|1500|8",
+		"COMMAND|switchwindow;sleep 50;tapkey ~;sleep 50;tapkey s a v e enter;sleep 50;tapkey ~|0|3",
+		"DIALOGUE|12|3",
+	};
+
+	FakeClock clock;
+	CommandDebouncer debouncer(clock);
+	const bool repeated = state.range(0) != 0;
+	size_t report = 0;
+	for (auto _ : state) {
+		const char *line = lines[(repeated ? report / 2 : report) % 4];
+		bool repeat = debouncer.IsRepeat(line);
+		benchmark::DoNotOptimize(repeat);
+
+		// The reports of a phrase arrive together, the next phrase after the window
+		report++;
+		if (!repeated || report % 2 == 0) {
+			clock.now += CommandDebouncer::kDefaultWindow;
+		}
+	}
+	state.counters["suppressed"] = (double)debouncer.Suppressed();
+}
+BENCHMARK(BM_CommandDebouncer)->Arg(0)->Arg(1);
@@ -0,0 +1,68 @@
+#include "CommandTable.h"
+#include "SpeechProtocol.h"
+#include "AllocationCounter.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+static const char *COMMANDS[] = {
+	"player.cast 0003f9ed player voice",
+	"press leftmousebutton 1000;sleep 500;tapkey r",
+	"switchwindow;sleep 50;tapkey ~;sleep 50;tapkey s a v e enter;sleep 50;tapkey ~",
+};
+
+// From a received line to the commands queued on the command lane (ResponseDispatcher::Dispatch).
+// Arg: 0 for COMMAND lines with the text of the commands, 1 for COMMAND_ID lines and the registered table.
+static void BM_DispatchCommand(benchmark::State &state) {
+	const bool byId = state.range(0) != 0;
+	CommandTable table;
+	std::string registration;
+	std::vector<std::string> lines;
+	for (int i = 0; i < 3; i++) {
+		registration += (i > 0 ? "|" : "") + std::to_string(i) + "|" + COMMANDS[i];
+		lines.push_back(byId ? "COMMAND_ID|" + std::to_string(i) + "|0|12" : std::string("COMMAND|") + COMMANDS[i] + "|0|12");
+	}
+	table.Register(registration);
+
+	std::vector<std::string_view> splitCommands;
+	std::vector<ParsedCommandPtr> queued;
+	std::vector<std::string> queuedText;
+	queued.reserve(16);
+	queuedText.reserve(16);
+	size_t line = 0;
+	uint64_t allocations = g_heapAllocations;
+	for (auto _ : state) {
+		Response response;
+		ParseResponse(lines[line++ % 3], response);
+		queued.clear();
+		queuedText.clear();
+		if (response.type == kResponse_CommandId) {
+			for (const ParsedCommandPtr &command : *table.Find(response.commandId))
+				queued.push_back(command);
+		}
+		else {
+			splitCommands.clear();
+			SplitCommands(response.payload, splitCommands);
+			for (std::string_view command : splitCommands)
+				queuedText.push_back(std::string(command));
+		}
+		benchmark::DoNotOptimize(queued.data());
+		benchmark::DoNotOptimize(queuedText.data());
+	}
+	state.counters["allocs"] = benchmark::Counter((double)(g_heapAllocations - allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_DispatchCommand)->Arg(0)->Arg(1);
+
+// REGISTER_COMMANDS for a command list of `range(0)` phrases, at startup and on each reload of the configuration
+static void BM_RegisterCommands(benchmark::State &state) {
+	std::string registration;
+	for (int64_t i = 0; i < state.range(0); i++) {
+		registration += (i > 0 ? "|" : "") + std::to_string(i) + "|" + COMMANDS[i % 3];
+	}
+	CommandTable table;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(table.Register(registration));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RegisterCommands)->Arg(50)->Arg(500);
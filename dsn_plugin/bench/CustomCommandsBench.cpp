@@ -0,0 +1,77 @@
+#include "CustomCommands.h"
+#include "KeyScanCode.h"
+#include "FakePlatform.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+static const char *COMMANDS[] = {
+	"player.cast 0003f9ed player voice",  // console command, not dispatched
+	"tapkey r",
+	"press  ctrl 500  alt 500  a 400",
+	"holdkey leftmousebutton",
+	"sleep 100",
+};
+
+// Dispatch of a command from the service, including the (fake) key events and sleeps
+static void BM_TryRunCustomCommand(benchmark::State &state) {
+	FakeClock clock;
+	FakeInputSink input;
+	FakeWindowLocator windows;
+	CustomCommandRunner runner(clock, input, windows);
+	const std::string command = COMMANDS[state.range(0)];
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(runner.TryRun(command));
+	}
+	state.SetLabel(command);
+	state.counters["keyEvents"] = benchmark::Counter((double)(input.keyDowns + input.keyUps), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_TryRunCustomCommand)->DenseRange(0, 4);
+
+// Same with the command parsed once, as registered in the command table
+static void BM_RunParsedCommand(benchmark::State &state) {
+	FakeClock clock;
+	FakeInputSink input;
+	FakeWindowLocator windows;
+	CustomCommandRunner runner(clock, input, windows);
+	const ParsedCommand command = CustomCommandRunner::Parse(COMMANDS[state.range(0)]);
+
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(runner.Run(command));
+	}
+	state.SetLabel(command.text);
+	state.counters["keyEvents"] = benchmark::Counter((double)(input.keyDowns + input.keyUps), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RunParsedCommand)->DenseRange(0, 4);
+
+static void BM_GetKeyScanCode(benchmark::State &state) {
+	static const char *keys[] = { "a", "LeftMouseButton", "0x2C", "44", "unknownkey" };
+	const std::string key = keys[state.range(0)];
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(GetKeyScanCode(key));
+	}
+	state.SetLabel(key);
+}
+BENCHMARK(BM_GetKeyScanCode)->DenseRange(0, 4);
+
+// press with 1 to 8 keys, all released at different times
+static void BM_BuildPressSchedule(benchmark::State &state) {
+	static const char *keys[] = { "ctrl", "alt", "a", "leftmousebutton", "0x2C", "shift", "e", "r" };
+	std::vector<std::string> params = { "press" };
+	for (int64_t i = 0; i < state.range(0); i++) {
+		params.push_back(keys[i]);
+		params.push_back(std::to_string(100 * (8 - i)));
+	}
+
+	std::vector<uint32_t> keyDown;
+	KeyReleaseSchedule keyUp;
+	for (auto _ : state) {
+		keyDown.clear();
+		keyUp.clear();
+		BuildPressSchedule(params, keyDown, keyUp);
+		benchmark::DoNotOptimize(keyDown.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildPressSchedule)->Arg(1)->Arg(3)->Arg(8);
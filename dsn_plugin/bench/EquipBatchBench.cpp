@@ -0,0 +1,30 @@
+#include "EquipBatch.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+// A loadout macro: armor pieces, both hands swapped twice, a shout and some potions
+static std::vector<PendingEquip> makeBatch(size_t size) {
+	static const EquipSlotMask slots[] = {
+		kEquipSlot_RightHand, kEquipSlot_LeftHand, 1 << 2, 1 << 3,
+		kEquipSlot_RightHand | kEquipSlot_LeftHand, kEquipSlot_Voice, 0, 1 << 7
+	};
+
+	std::vector<PendingEquip> batch;
+	for (size_t i = 0; i < size; i++) {
+		PendingEquip equip = { { (uint32_t)i, 0, 1, 1 }, slots[i % 8], nullptr, false };
+		batch.push_back(equip);
+	}
+	return batch;
+}
+
+static void BM_CoalesceEquips(benchmark::State &state) {
+	const std::vector<PendingEquip> batch = makeBatch(state.range(0));
+	std::vector<PendingEquip> work;
+	work.reserve(batch.size());
+	for (auto _ : state) {
+		work.assign(batch.begin(), batch.end());
+		size_t dropped = CoalesceEquips(work);
+		benchmark::DoNotOptimize(dropped);
+	}
+}
+BENCHMARK(BM_CoalesceEquips)->Arg(1)->Arg(8)->Arg(32);
@@ -0,0 +1,58 @@
+#include "EquipParser.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The parser used before ParseEquipItem(), kept here as a baseline.
+static EquipItem legacyParseEquipItem(std::string command) {
+	std::stringstream ss(command);
+	std::string token;
+	std::vector<std::string> tokens;
+	while (std::getline(ss, token, ';')) {
+		tokens.push_back(token);
+	}
+
+	char* formId = (char*)tokens[0].c_str();
+	char* end = formId + strlen(formId);
+
+	EquipItem item = {
+		(uint32_t)std::strtoul(formId, &end, 10),
+		(int32_t)std::atoi(tokens[1].c_str()),
+		(uint8_t)std::atoi(tokens[2].c_str()),
+		(int32_t)std::atoi(tokens[3].c_str())
+	};
+	return item;
+}
+
+static const std::string kEquipPayload = "324567;-1938273645;1;2";
+
+static void BM_ParseEquipItem_Legacy(benchmark::State &state) {
+	for (auto _ : state) {
+		EquipItem item = legacyParseEquipItem(kEquipPayload);
+		benchmark::DoNotOptimize(item);
+	}
+}
+BENCHMARK(BM_ParseEquipItem_Legacy);
+
+static void BM_ParseEquipItem(benchmark::State &state) {
+	for (auto _ : state) {
+		EquipItem item;
+		EquipParseResult result = ParseEquipItem(kEquipPayload, item);
+		benchmark::DoNotOptimize(result);
+		benchmark::DoNotOptimize(item);
+	}
+}
+BENCHMARK(BM_ParseEquipItem);
+
+static void BM_ParseEquipItem_Malformed(benchmark::State &state) {
+	const std::string payload = "324567;abc;1;2";
+	for (auto _ : state) {
+		EquipItem item;
+		EquipParseResult result = ParseEquipItem(payload, item);
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(BM_ParseEquipItem_Malformed);
@@ -0,0 +1,56 @@
+#pragma once
+#include "Platform.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+// Platform.h implementations for the benchmarks: nothing sleeps, no input is sent
+
+// Advances its time instead of sleeping
+class FakeClock : public IClock
+{
+public:
+	uint64_t now = 0;
+
+	uint64_t NowMilliseconds() override { return now; }
+	void SleepMilliseconds(uint32_t milliseconds) override { now += milliseconds; }
+};
+
+// Counts the key events
+class FakeInputSink : public IInputSink
+{
+public:
+	uint64_t keyDowns = 0;
+	uint64_t keyUps = 0;
+
+	void KeyDown(uint32_t) override { keyDowns++; }
+	void KeyUp(uint32_t) override { keyUps++; }
+};
+
+class FakeWindowLocator : public IWindowLocator
+{
+public:
+	bool ActivateWindow(const std::string &) override { return true; }
+};
+
+// Replays `data` in reads of at most `chunkSize` bytes, then reports the pipe as closed.
+// Writes are discarded.
+class FakePipe : public IPipe
+{
+public:
+	std::string data;
+	size_t chunkSize = 4096;
+	size_t position = 0;
+
+	int Read(char *buffer, size_t size) override {
+		if (position >= data.size()) {
+			return -1;
+		}
+		size_t count = std::min(std::min(size, chunkSize), data.size() - position);
+		memcpy(buffer, data.data() + position, count);
+		position += count;
+		return (int)count;
+	}
+
+	bool Write(const char *, size_t) override { return true; }
+};
@@ -0,0 +1,249 @@
+#include "FavoritesSnapshot.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+// Plain memory stand-ins for the game's inventory structures, linked the same way:
+// InventoryEntryData -> ExtendDataList (linked list) -> BaseExtraList -> BSExtraData (linked list)
+namespace synthetic {
+
+	enum {
+		kExtraData_Hotkey = 0x4A,
+		kExtraData_TextDisplayData = 0x99
+	};
+
+	struct TESForm {
+		uint32_t formID;
+		std::string fullName;
+		bool singleHanded;
+	};
+
+	struct BSExtraData {
+		uint8_t type;
+		BSExtraData *next;
+	};
+
+	struct ExtraTextDisplayData : BSExtraData {
+		const char *name;
+	};
+
+	struct BaseExtraList {
+		BSExtraData *data;
+		const char *displayName;
+
+		BSExtraData * GetByType(uint8_t type) const {
+			for (BSExtraData *extra = data; extra; extra = extra->next) {
+				if (extra->type == type)
+					return extra;
+			}
+			return nullptr;
+		}
+	};
+
+	struct ExtendDataList {
+		BaseExtraList *item;
+		ExtendDataList *next;
+
+		BaseExtraList * GetNthItem(int32_t n) const {
+			const ExtendDataList *node = this;
+			for (; node && n > 0; n--) {
+				node = node->next;
+			}
+			return node ? node->item : nullptr;
+		}
+	};
+
+	struct InventoryEntryData {
+		TESForm *type;
+		ExtendDataList *extendDataList;
+	};
+
+	// Owns a synthetic inventory of `size` items, `hotkeyPercent` % of them favorited
+	struct Inventory {
+		std::deque<TESForm> forms;
+		std::deque<BSExtraData> extraData;
+		std::deque<ExtraTextDisplayData> textDisplayData;
+		std::deque<BaseExtraList> extraLists;
+		std::deque<ExtendDataList> extendDataLists;
+		std::vector<InventoryEntryData> entries;
+
+		Inventory(size_t size, int hotkeyPercent) {
+			std::mt19937 rng(42);
+			std::uniform_int_distribution<int> percent(0, 99);
+
+			for (size_t i = 0; i < size; i++) {
+				forms.push_back({ (uint32_t)(0x00012EB7 + i), "Item " + std::to_string(i), percent(rng) < 40 });
+				InventoryEntryData entry = { &forms.back(), nullptr };
+
+				// Most items are plain stacks without extra data, some have one or two extra lists
+				// (worn, enchanted, renamed, ...)
+				int extraListCount = percent(rng) < 70 ? 0 : 1 + percent(rng) % 2;
+				bool hotkeyed = percent(rng) < hotkeyPercent;
+				if (hotkeyed && extraListCount == 0)
+					extraListCount = 1;
+
+				ExtendDataList *head = nullptr;
+				for (int l = 0; l < extraListCount; l++) {
+					BSExtraData *data = nullptr;
+					extraData.push_back({ 0x1F /* worn */, data });
+					data = &extraData.back();
+					const char *displayName = nullptr;
+					if (percent(rng) < 10) {
+						textDisplayData.push_back({});
+						ExtraTextDisplayData &text = textDisplayData.back();
+						text.type = kExtraData_TextDisplayData;
+						text.next = data;
+						text.name = "Renamed item";
+						data = &text;
+						displayName = text.name;
+					}
+					if (hotkeyed && l == extraListCount - 1) {
+						extraData.push_back({ kExtraData_Hotkey, data });
+						data = &extraData.back();
+					}
+					extraLists.push_back({ data, displayName });
+					extendDataLists.push_back({ &extraLists.back(), head });
+					head = &extendDataLists.back();
+				}
+				entry.extendDataList = head;
+				entries.push_back(entry);
+			}
+		}
+	};
+
+	struct InventoryTraits {
+		typedef InventoryEntryData Entry;
+		typedef TESForm Form;
+		typedef BaseExtraList ExtraList;
+
+		static Form * GetForm(Entry *entry) { return entry->type; }
+		static uint32_t GetFormId(Form *form) { return form->formID; }
+		static const char * GetFullName(Form *form) { return form->fullName.c_str(); }
+		static bool IsSingleHanded(Form *form) { return form->singleHanded; }
+		static ExtraList * GetNthExtraList(Entry *entry, int32_t n) {
+			return entry->extendDataList ? entry->extendDataList->GetNthItem(n) : nullptr;
+		}
+		static bool HasHotkey(ExtraList *extraList) { return extraList->GetByType(kExtraData_Hotkey) != nullptr; }
+		static const char * GetDisplayName(ExtraList *extraList, Form *) { return extraList->displayName; }
+		static const char * GetTextDisplayName(ExtraList *extraList) {
+			BSExtraData *extra = extraList->GetByType(kExtraData_TextDisplayData);
+			return extra ? static_cast<ExtraTextDisplayData*>(extra)->name : nullptr;
+		}
+	};
+
+	// ExtraContainerChanges::FindHotkey(TESForm*): visits the whole inventory
+	static bool FindHotkey(std::vector<InventoryEntryData> &entries, TESForm *form) {
+		for (InventoryEntryData &entry : entries) {
+			if (entry.type != form)
+				continue;
+			for (ExtendDataList *node = entry.extendDataList; node; node = node->next) {
+				if (node->item && InventoryTraits::HasHotkey(node->item))
+					return true;
+			}
+		}
+		return false;
+	}
+}
+
+using namespace synthetic;
+
+static void setCounters(benchmark::State &state, const std::vector<FavoriteMenuItem> &favorites) {
+	state.counters["favorites"] = (double)favorites.size();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_ExtractFavorites(benchmark::State &state) {
+	Inventory inventory(state.range(0), (int)state.range(1));
+	std::vector<FavoriteMenuItem> favorites;
+	for (auto _ : state) {
+		favorites.clear();
+		for (InventoryEntryData &entry : inventory.entries) {
+			ExtractFavorites<InventoryTraits>(&entry, favorites);
+		}
+		benchmark::DoNotOptimize(favorites.data());
+	}
+	setCounters(state, favorites);
+}
+
+// The refresh path before the single pass: FindHotkey() on every entry before extracting it
+static void BM_ExtractFavorites_FindHotkey(benchmark::State &state) {
+	Inventory inventory(state.range(0), (int)state.range(1));
+	std::vector<FavoriteMenuItem> favorites;
+	for (auto _ : state) {
+		favorites.clear();
+		for (InventoryEntryData &entry : inventory.entries) {
+			if (FindHotkey(inventory.entries, entry.type)) {
+				ExtractFavorites<InventoryTraits>(&entry, favorites);
+			}
+		}
+		benchmark::DoNotOptimize(favorites.data());
+	}
+	setCounters(state, favorites);
+}
+
+// A full refresh without changes: extract, serialize and compare with the last FAVORITES message
+static void BM_RefreshFavorites(benchmark::State &state) {
+	Inventory inventory(state.range(0), (int)state.range(1));
+	std::vector<FavoriteMenuItem> favorites;
+	std::string command;
+	std::string lastCommand;
+	for (auto _ : state) {
+		favorites.clear();
+		for (InventoryEntryData &entry : inventory.entries) {
+			ExtractFavorites<InventoryTraits>(&entry, favorites);
+		}
+		BuildFavoritesCommand(favorites, command);
+		bool changed = lastCommand != command;
+		if (changed) {
+			lastCommand.swap(command);
+		}
+		benchmark::DoNotOptimize(changed);
+	}
+	setCounters(state, favorites);
+	state.counters["bytes"] = (double)lastCommand.size();
+}
+
+static void BM_BuildFavoritesCommand(benchmark::State &state) {
+	Inventory inventory(state.range(0), (int)state.range(1));
+	std::vector<FavoriteMenuItem> favorites;
+	for (InventoryEntryData &entry : inventory.entries) {
+		ExtractFavorites<InventoryTraits>(&entry, favorites);
+	}
+	std::string command;
+	for (auto _ : state) {
+		BuildFavoritesCommand(favorites, command);
+		benchmark::DoNotOptimize(command.data());
+	}
+	setCounters(state, favorites);
+}
+
+static void BM_CalcFavoriteItemId(benchmark::State &state) {
+	const char *name = "Glass Sword of the Inferno";
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(CalcFavoriteItemId(name, 0x0001398E));
+	}
+	state.SetBytesProcessed(state.iterations() * strlen(name));
+}
+BENCHMARK(BM_CalcFavoriteItemId);
+
+// HashUtil::CRC32 over names of different lengths
+static void BM_FavoritesCRC32(benchmark::State &state) {
+	const std::string name(state.range(0), 'a');
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(FavoritesCRC32(name.c_str(), 0x0001398E));
+	}
+	state.SetBytesProcessed(state.iterations() * name.size());
+}
+BENCHMARK(BM_FavoritesCRC32)->Arg(8)->Arg(32)->Arg(128);
+
+// Inventory sizes x percentage of favorited items
+#define FAVORITES_ARGS ArgsProduct({ { 100, 1000, 10000 }, { 1, 10, 50 } })
+
+BENCHMARK(BM_ExtractFavorites)->FAVORITES_ARGS;
+// Quadratic, 10k items take about a second per iteration
+BENCHMARK(BM_ExtractFavorites_FindHotkey)->ArgsProduct({ { 100, 1000 }, { 1, 10, 50 } })->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RefreshFavorites)->FAVORITES_ARGS;
+BENCHMARK(BM_BuildFavoritesCommand)->FAVORITES_ARGS;
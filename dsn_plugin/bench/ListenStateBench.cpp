@@ -0,0 +1,35 @@
+#include "ListenState.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+// The per-frame cost of push-to-talk on the game thread, key released most of the time:
+// one PushToTalk() call per frame, a pause and a resume every 120 frames
+static void BM_PushToTalkFrame(benchmark::State &state) {
+	ListenState listenState;
+	listenState.SetPushToTalk(true, 100);
+	std::string line;
+	uint64_t now = 1;
+	uint64_t frame = 0;
+	uint64_t changes = 0;
+	for (auto _ : state) {
+		bool held = frame++ % 120 < 30;
+		now += 16;
+		if (listenState.PushToTalk(held, now, line)) {
+			changes++;
+		}
+	}
+	state.counters["changes"] = (double)changes;
+}
+BENCHMARK(BM_PushToTalkFrame);
+
+// Opening and closing a menu that does not pause the recognition, looked up in the default list
+static void BM_MenuOpenClose(benchmark::State &state) {
+	ListenState listenState;
+	listenState.SetPausingMenus(ListenState::kDefaultPausingMenus);
+	std::string line;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(listenState.MenuOpenClose("InventoryMenu", true, line));
+		benchmark::DoNotOptimize(listenState.MenuOpenClose("InventoryMenu", false, line));
+	}
+}
+BENCHMARK(BM_MenuOpenClose);
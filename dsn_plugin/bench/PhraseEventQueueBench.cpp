@@ -0,0 +1,31 @@
+#include "PhraseEventQueue.h"
+#include "ResponseDispatcher.h"
+#include "FakePlatform.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// `range(0)` PAPYRUS_EVENT lines dispatched between two frames, then taken at once by the game thread
+// like PapyrusPhraseEvents::Update()
+static void BM_PapyrusEventBatch(benchmark::State &state) {
+	FakeClock clock;
+	ResponseDispatcher dispatcher(clock, nullptr);
+	dispatcher.SetRepeatWindow(0);
+	std::vector<std::string> lines;
+	for (int64_t i = 0; i < state.range(0); i++) {
+		lines.push_back("PAPYRUS_EVENT|" + std::to_string(i) + "|0.912|Call my horse number " + std::to_string(i));
+	}
+
+	std::vector<PhraseEvent> batch;
+	uint64_t taken = 0;
+	for (auto _ : state) {
+		for (const std::string &line : lines) {
+			dispatcher.Dispatch(line);
+		}
+		dispatcher.PopPhraseEvents(batch);
+		taken += batch.size();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.counters["taken"] = benchmark::Counter((double)taken, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_PapyrusEventBatch)->Arg(1)->Arg(16);
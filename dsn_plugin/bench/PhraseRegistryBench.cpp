@@ -0,0 +1,60 @@
+#include "PhraseRegistry.h"
+#include "ResponseDispatcher.h"
+#include "FakePlatform.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+static void countRecognition(uint32_t /*phraseId*/, void *userData) {
+	(*(uint64_t *)userData)++;
+}
+
+// A plugin binding `range(0)` phrases at load: registration, then the REGISTER_PHRASES line sent at the next frame
+static void BM_RegisterPhrases(benchmark::State &state) {
+	std::vector<std::string> phrases;
+	for (int64_t i = 0; i < state.range(0); i++) {
+		phrases.push_back("summon companion number " + std::to_string(i));
+	}
+	uint64_t recognized = 0;
+	std::vector<std::string> lines;
+	size_t bytes = 0;
+	for (auto _ : state) {
+		PhraseRegistry registry;
+		for (const std::string &phrase : phrases) {
+			registry.Register(phrase, countRecognition, &recognized);
+		}
+		lines.clear();
+		registry.TakePendingLines(lines);
+		bytes += lines[0].size();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_RegisterPhrases)->Arg(100)->Arg(5000);
+
+// From a PHRASE line received from the service to the callback on the game thread: Dispatch(), then
+// PopPhrases() and Deliver() once per frame, like SpeechRecognitionClient::UpdatePhrases()
+static void BM_DeliverPhrase(benchmark::State &state) {
+	const int64_t phraseCount = 5000;
+	FakeClock clock;
+	ResponseDispatcher dispatcher(clock, nullptr);
+	dispatcher.SetRepeatWindow(0);
+	PhraseRegistry registry;
+	uint64_t recognized = 0;
+	std::vector<std::string> lines;
+	for (int64_t i = 0; i < phraseCount; i++) {
+		registry.Register("summon companion number " + std::to_string(i), countRecognition, &recognized);
+		lines.push_back("PHRASE|" + std::to_string(i + 1));
+	}
+
+	std::vector<uint32_t> ids;
+	size_t line = 0;
+	for (auto _ : state) {
+		dispatcher.Dispatch(lines[line++ % phraseCount]);
+		ids.clear();
+		dispatcher.PopPhrases(ids);
+		registry.Deliver(ids);
+	}
+	state.counters["delivered"] = (double)recognized;
+}
+BENCHMARK(BM_DeliverPhrase);
@@ -0,0 +1,139 @@
+#include "SpeechProtocol.h"
+#include "AllocationCounter.h"
+#include "FakePlatform.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// What the service sends during a play session: mostly voice commands, some dialogue and equips
+static std::string makeServiceOutput(size_t lineCount) {
+	static const char *lines[] = {
+		"COMMAND|player.cast 0003f9ed player voice\n",
+		"DIALOGUE|12|3\n",
+		"EQUIP|77495;-1523455213;1;1\n",
+		"COMMAND|press leftmousebutton 1000;sleep 500;tapkey r\n",
+		"COMMAND|switchwindow;sleep 50;tapkey ~;sleep 50;tapkey s a v e enter;sleep 50;tapkey ~\n",
+		"EQUIP|77495;0;2;0\n",
+	};
+
+	std::string output;
+	for (size_t i = 0; i < lineCount; i++) {
+		output += lines[i % 6];
+	}
+	return output;
+}
+
+// LineReader::ReadLine + ParseResponse + SplitCommands, the receiving side of AwaitResponses()
+static void BM_AwaitResponses(benchmark::State &state) {
+	FakePipe pipe;
+	pipe.data = makeServiceOutput(state.range(0));
+	pipe.chunkSize = state.range(1);
+	FakeClock clock;
+	std::string line;
+	std::vector<std::string_view> commands;
+	size_t lines = 0;
+
+	for (auto _ : state) {
+		pipe.position = 0;
+		LineReader reader(pipe, clock);
+		while (reader.ReadLine(line)) {
+			Response response;
+			if (ParseResponse(line, response) && response.type == kResponse_Command) {
+				commands.clear();
+				SplitCommands(response.payload, commands);
+				benchmark::DoNotOptimize(commands.data());
+			}
+			lines++;
+		}
+	}
+	state.SetItemsProcessed(lines);
+	state.SetBytesProcessed(state.iterations() * pipe.data.size());
+}
+// lines x bytes per read (the service flushes every line, so reads are usually small)
+BENCHMARK(BM_AwaitResponses)->ArgsProduct({ { 600 }, { 64, 4096 } });
+
+static void BM_ParseResponse(benchmark::State &state) {
+	static const std::string lines[] = {
+		"DIALOGUE|12|3",
+		"COMMAND|press leftmousebutton 1000;sleep 500;tapkey r",
+		"EQUIP|77495;-1523455213;1;1",
+	};
+	const std::string &line = lines[state.range(0)];
+	for (auto _ : state) {
+		Response response;
+		benchmark::DoNotOptimize(ParseResponse(line, response));
+		benchmark::DoNotOptimize(response);
+	}
+}
+BENCHMARK(BM_ParseResponse)->DenseRange(0, 2);
+
+// The arguments of the PopulateDialogueList invoke: the command, then 3 values per topic starting with its text
+static std::vector<const char *> makeDialogueArguments(int64_t topicCount, std::vector<std::string> &topics) {
+	for (int64_t i = 0; i < topicCount; i++) {
+		topics.push_back("I'm looking for work, topic " + std::to_string(i) + ".");
+	}
+	std::vector<const char *> argv;
+	argv.push_back("PopulateDialogueList");
+	for (const std::string &topic : topics) {
+		argv.push_back(topic.c_str());
+		argv.push_back("");
+		argv.push_back("");
+	}
+	argv.push_back("");
+	return argv;
+}
+
+// Previous Hook_Invoke -> StartDialogue path: the topics copied into a vector, the DialogueList passed
+// by value, then the message grown with append
+struct LegacyDialogueList {
+	std::vector<std::string> lines;
+};
+
+static void legacyBuildStartDialogue(int dialogueId, LegacyDialogueList list, std::string &command) {
+	command = "START_DIALOGUE|" + std::to_string(dialogueId);
+	for (const std::string &line : list.lines) {
+		command.append("|");
+		command.append(line);
+	}
+}
+
+static void BM_StartDialogue_Copies(benchmark::State &state) {
+	std::vector<std::string> topics;
+	std::vector<const char *> argv = makeDialogueArguments(state.range(0), topics);
+	int dialogueId = 0;
+	uint64_t allocations = g_heapAllocations;
+	for (auto _ : state) {
+		std::vector<std::string> lines;
+		for (size_t j = 1; j < argv.size() - 1; j = j + 3) {
+			lines.push_back(std::string(argv[j]));
+		}
+		LegacyDialogueList dialogueList;
+		dialogueList.lines = lines;
+		std::string command;
+		legacyBuildStartDialogue(++dialogueId, dialogueList, command);
+		benchmark::DoNotOptimize(command.data());
+	}
+	state.counters["allocs"] = benchmark::Counter((double)(g_heapAllocations - allocations), benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StartDialogue_Copies)->Arg(1)->Arg(5)->Arg(10)->Arg(20)->Arg(30);
+
+// SpeechRecognitionClient::StartDialogue: serialized from the arguments into the dialogue arena
+static void BM_StartDialogue(benchmark::State &state) {
+	std::vector<std::string> topics;
+	std::vector<const char *> argv = makeDialogueArguments(state.range(0), topics);
+	const char **arguments = argv.data();
+	DialogueArena arena;
+	int dialogueId = 0;
+	uint64_t allocations = g_heapAllocations;
+	for (auto _ : state) {
+		std::string_view command = BuildStartDialogue(++dialogueId, argv.size() / 3, [arguments](size_t topic) {
+			return arguments[1 + topic * 3];
+		}, arena);
+		benchmark::DoNotOptimize(command.data());
+	}
+	state.counters["allocs"] = benchmark::Counter((double)(g_heapAllocations - allocations), benchmark::Counter::kAvgIterations);
+	state.counters["arena_blocks"] = (double)arena.BlockAllocations();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StartDialogue)->Arg(1)->Arg(5)->Arg(10)->Arg(20)->Arg(30);
@@ -0,0 +1,108 @@
+#ifndef _WIN32
+#include "PosixPlatform.h"
+#include "SpeechProtocol.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+// The plugin <-> service transports, anonymous pipes (stdin/stdout) and the shared memory rings,
+// against dsn_fake_service. Arg: 0 for the pipes, 1 for the shared memory.
+
+static const int kBurstLines = 1000;
+
+// Launches dsn_fake_service with `script` and connects to it
+class FakeServiceConnection
+{
+public:
+	FakeServiceConnection(const std::string &script, bool useSharedMemory) {
+		static int connections = 0;
+		std::string id = std::to_string(getpid()) + "_" + std::to_string(++connections);
+		scriptPath = "/tmp/dsn_bench_" + id + ".txt";
+		FILE *file = fopen(scriptPath.c_str(), "w");
+		if (file) {
+			fputs(script.c_str(), file);
+			fclose(file);
+		}
+
+		std::string commandLine = std::string(DSN_FAKE_SERVICE) + " " + scriptPath;
+		if (useSharedMemory) {
+			std::string name = "/dsn_bench_" + id;
+			if (!sharedMemory.Create(name)) {
+				return;
+			}
+			commandLine += " --shared-memory " + name;
+		}
+		if (!process.Start(commandLine)) {
+			return;
+		}
+		pipe = &process;
+		if (useSharedMemory) {
+			sharedMemory.SetPeerCheck([this] { return process.IsRunning(); });
+			pipe = sharedMemory.WaitForService(5000) ? &sharedMemory : nullptr;
+		}
+	}
+
+	~FakeServiceConnection() {
+		sharedMemory.Close();
+		process.Stop();
+		remove(scriptPath.c_str());
+	}
+
+	IPipe *pipe = nullptr;
+
+private:
+	std::string scriptPath;
+	PosixProcessPipe process;
+	PosixSharedMemoryPipe sharedMemory{ SharedMemoryPipe::kSide_Plugin };
+};
+
+// One line to the service and its answer: the latency of a message in each direction
+static void BM_TransportRoundTrip(benchmark::State &state) {
+	FakeServiceConnection service("repeat 1000000000\nexpect STOP_DIALOGUE\nsend COMMAND|tapkey r\nend\n", state.range(0) != 0);
+	if (!service.pipe) {
+		state.SkipWithError("cannot start dsn_fake_service");
+		return;
+	}
+	SteadyClock clock;
+	LineReader reader(*service.pipe, clock);
+	std::string line;
+
+	for (auto _ : state) {
+		if (!service.pipe->Write("STOP_DIALOGUE\n", 14) || !reader.ReadLine(line)) {
+			state.SkipWithError("the service closed the connection");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransportRoundTrip)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// Bursts of commands from the service, written and flushed one line at a time like the real service does
+static void BM_TransportBurst(benchmark::State &state) {
+	FakeServiceConnection service("repeat 1000000000\nexpect STOP_DIALOGUE\nburst " + std::to_string(kBurstLines)
+		+ " 0 COMMAND|player.cast 0003f9ed player voice\nend\n", state.range(0) != 0);
+	if (!service.pipe) {
+		state.SkipWithError("cannot start dsn_fake_service");
+		return;
+	}
+	SteadyClock clock;
+	LineReader reader(*service.pipe, clock);
+	std::string line;
+	int64_t bytes = 0;
+
+	for (auto _ : state) {
+		if (!service.pipe->Write("STOP_DIALOGUE\n", 14)) {
+			state.SkipWithError("the service closed the connection");
+			break;
+		}
+		for (int i = 0; i < kBurstLines && reader.ReadLine(line); i++) {
+			bytes += line.size() + 1;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * kBurstLines);
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_TransportBurst)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMicrosecond);
+#endif
@@ -0,0 +1,40 @@
+#include "CommandDebouncer.h"
+#include "SpeechProtocol.h"
+
+CommandDebouncer::CommandDebouncer(IClock &clock, uint32_t window)
+	: clock(clock), window(window) {
+}
+
+bool CommandDebouncer::IsRepeat(std::string_view line) {
+	static const std::string_view kPrefixes[] = { "COMMAND|", "COMMAND_ID|", "PHRASE|", "PAPYRUS_EVENT|" };
+
+	uint32_t windowLength = GetWindow();
+	size_t prefixLength = 0;
+	if (windowLength == 0) {
+		return false;
+	}
+	for (std::string_view prefix : kPrefixes) {
+		if (line.compare(0, prefix.size(), prefix) == 0) {
+			prefixLength = prefix.size();
+			break;
+		}
+	}
+	if (prefixLength == 0) {
+		return false;
+	}
+
+	// Only the type and the commands (or id) are hashed, the deadline and the age differ between the reports of a phrase
+	std::string_view key = line.substr(0, line.find('|', prefixLength));
+	uint64_t hash = DialogueLineHash(key.data(), key.size());
+	uint64_t now = clock.NowMilliseconds();
+
+	Slot &slot = slots[hash % kSlots];
+	if (slot.used && slot.hash == hash && now - slot.receivedAt < windowLength) {
+		suppressed.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+	slot.hash = hash;
+	slot.receivedAt = now;
+	slot.used = true;
+	return false;
+}
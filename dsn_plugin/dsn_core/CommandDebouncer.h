@@ -0,0 +1,45 @@
+#pragma once
+#include "Platform.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Drops the COMMAND, COMMAND_ID, PHRASE and PAPYRUS_EVENT lines of a phrase System.Speech reported twice in quick succession
+// (RecognizeMode.Multiple), which would run its commands again. Lines are keyed by the hash of their commands
+// (or id), a repeat is a line with the same commands as one received less than the window ago.
+//
+// IsRepeat() is called on the thread reading the service's output only: its table is not shared and has no lock.
+// The window and the counters are atomics, they can be used from any thread.
+class CommandDebouncer
+{
+public:
+	static const uint32_t kDefaultWindow = 400;
+
+	explicit CommandDebouncer(IClock &clock, uint32_t window = kDefaultWindow);
+
+	// 0 disables the debouncing
+	void SetWindow(uint32_t milliseconds) { window.store(milliseconds, std::memory_order_relaxed); }
+	uint32_t GetWindow() const { return window.load(std::memory_order_relaxed); }
+
+	// Returns true if `line` is one of these lines repeating one received within the window
+	bool IsRepeat(std::string_view line);
+
+	uint64_t Suppressed() const { return suppressed.load(std::memory_order_relaxed); }
+
+private:
+	// Direct-mapped by hash: commands of different phrases rarely share a slot,
+	// and when they do the older one is only forgotten earlier
+	static const size_t kSlots = 16;
+
+	struct Slot {
+		uint64_t hash;
+		uint64_t receivedAt;
+		bool used;
+	};
+
+	IClock &clock;
+	std::atomic<uint32_t> window;
+	std::atomic<uint64_t> suppressed{ 0 };
+	Slot slots[kSlots] = {};
+};
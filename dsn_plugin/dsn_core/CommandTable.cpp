@@ -0,0 +1,49 @@
+#include "CommandTable.h"
+#include "SpeechProtocol.h"
+#include <charconv>
+
+size_t CommandTable::Register(std::string_view payload) {
+	std::vector<std::string_view> commands;
+	entries.clear();
+	registered = 0;
+
+	while (!payload.empty()) {
+		size_t sep = payload.find('|');
+		std::string_view idField = payload.substr(0, sep);
+		payload = sep == std::string_view::npos ? std::string_view() : payload.substr(sep + 1);
+		sep = payload.find('|');
+		std::string_view commandsField = payload.substr(0, sep);
+		payload = sep == std::string_view::npos ? std::string_view() : payload.substr(sep + 1);
+
+		int id = -1;
+		std::from_chars_result res = std::from_chars(idField.data(), idField.data() + idField.size(), id);
+		if (res.ec != std::errc() || res.ptr != idField.data() + idField.size() || id < 0 || id > kMaxId) {
+			continue;
+		}
+
+		commands.clear();
+		SplitCommands(commandsField, commands);
+		if (commands.empty()) {
+			continue;
+		}
+
+		if ((size_t)id >= entries.size()) {
+			entries.resize(id + 1);
+		}
+		std::vector<ParsedCommandPtr> &entry = entries[id];
+		if (entry.empty()) {
+			registered++;
+		}
+		entry.clear();
+		for (std::string_view command : commands)
+			entry.push_back(std::make_shared<const ParsedCommand>(CustomCommandRunner::Parse(std::string(command))));
+	}
+	return registered;
+}
+
+const std::vector<ParsedCommandPtr> *CommandTable::Find(int id) const {
+	if (id < 0 || (size_t)id >= entries.size() || entries[id].empty()) {
+		return nullptr;
+	}
+	return &entries[id];
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "CustomCommands.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Commands the service registered with REGISTER_COMMANDS (see SpeechProtocol.h). A recognized phrase is then
+// sent as COMMAND_ID with the id of its commands: they are split and parsed once, when the table is registered
+// (see CustomCommandRunner::Parse), and dispatching an id is an index in the table. The parsed commands are
+// shared with the command lane, they stay valid when the table is registered again.
+//
+// Used on the thread reading the service's output only, like Dispatch(): it has no lock.
+class CommandTable
+{
+public:
+	// Ids are indexes, the service numbers its commands from 0. Larger ids are ignored.
+	static const int kMaxId = 0xFFFF;
+
+	// Replace the table with the entries of a REGISTER_COMMANDS payload: <id>|<commands>|<id>|<commands>...
+	// Entries with a malformed id or no commands are skipped. Returns the number of registered entries.
+	size_t Register(std::string_view payload);
+
+	// Returns the commands registered for `id`, or nullptr
+	const std::vector<ParsedCommandPtr> *Find(int id) const;
+
+	size_t Size() const { return registered; }
+
+private:
+	std::vector<std::vector<ParsedCommandPtr>> entries;  // empty for the ids that are not registered
+	size_t registered = 0;
+};
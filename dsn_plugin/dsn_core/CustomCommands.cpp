@@ -0,0 +1,180 @@
+#include "CustomCommands.h"
+#include "KeyScanCode.h"
+#include "StringUtils.hpp"
+#include "Log.h"
+#include <cstdlib>
+
+void BuildPressSchedule(std::vector<std::string> params, std::vector<uint32_t> &keyDown, KeyReleaseSchedule &keyUp) {
+	// If time does not exist, set as kDefaultKeyPressTime milliseconds
+	if ((params.size() - 1) % 2 > 0) {
+		params.push_back(std::to_string(CustomCommandRunner::kDefaultKeyPressTime));
+	}
+
+	// command: press <key> <time> <key> <time> ...
+	//           [0]   [1]   [2]    [3]   [4]
+	for (size_t i = 1; i + 1 < params.size(); i += 2) {
+		const std::string &keyStr = params[i];
+		const std::string &timeStr = params[i + 1];
+		uint32_t key = 0;
+		uint32_t time = 0;
+
+		if (keyStr.empty()) {
+			continue;
+		}
+
+		key = GetKeyScanCode(keyStr);
+		if (key == 0) {
+			continue;
+		}
+
+		time = strtol(timeStr.c_str(), NULL, 10);
+		if (time == 0) {
+			continue;
+		}
+
+		keyDown.push_back(key);
+
+		// Map is used to sort by time.
+		// Avoiding map key conflicts.
+		// Although it changes the time, it is more convenient than sorting by myself.
+		while (keyUp.find(time) != keyUp.end()) {
+			time++;
+		}
+		keyUp[time] = key;
+	}
+}
+
+// Registered custom commands
+const CustomCommandRunner::CustomCommandEntry CustomCommandRunner::customCmdList[] = {
+	{ "press", &CustomCommandRunner::Press },
+	{ "tapkey", &CustomCommandRunner::TapKey },
+	{ "holdkey", &CustomCommandRunner::HoldKey },
+	{ "releasekey", &CustomCommandRunner::ReleaseKey },
+	{ "sleep", &CustomCommandRunner::Sleep },
+	{ "switchwindow", &CustomCommandRunner::SwitchWindow },
+};
+
+CustomCommandRunner::CustomCommandRunner(IClock &clock, IInputSink &input, IWindowLocator &windows)
+	: clock(clock), input(input), windows(windows) {
+}
+
+ParsedCommand CustomCommandRunner::Parse(std::string command) {
+	ParsedCommand parsed;
+	parsed.params = splitParams(command);
+	parsed.text = std::move(command);
+
+	if (!parsed.params.empty()) {
+		std::string action = parsed.params[0];
+		stringToLower(action);
+
+		for (size_t i = 0; i < sizeof(customCmdList) / sizeof(customCmdList[0]); i++) {
+			if (action == customCmdList[i].name) {
+				parsed.custom = (int)i;
+				return parsed;
+			}
+		}
+	}
+
+	// Skyrim console commands are run as received
+	parsed.params.clear();
+	return parsed;
+}
+
+bool CustomCommandRunner::TryRun(const std::string & command) {
+	return Run(Parse(command));
+}
+
+bool CustomCommandRunner::Run(const ParsedCommand &command) {
+	if (!command.IsCustom()) {
+		return false;
+	}
+
+	(this->*customCmdList[command.custom].func)(command.params);
+	return true;
+}
+
+void CustomCommandRunner::Press(const std::vector<std::string> &params) {
+	std::vector<uint32_t> keyDown;
+	KeyReleaseSchedule keyUp;
+	BuildPressSchedule(params, keyDown, keyUp);
+
+	// send KEY_DOWN
+	for (auto itr = keyDown.begin(); itr != keyDown.end(); itr++) {
+		input.KeyDown(*itr);
+	}
+
+	// send KEY_UP
+	uint32_t totalSleepTime = 0;
+	for (auto itr = keyUp.begin(); itr != keyUp.end(); itr++) {
+		uint32_t sleepTime = itr->first - totalSleepTime;
+		clock.SleepMilliseconds(sleepTime);
+		totalSleepTime += sleepTime;
+
+		input.KeyUp(itr->second);
+	}
+}
+
+void CustomCommandRunner::TapKey(const std::vector<std::string> &params) {
+	std::vector<std::string> newParams = { "press" };
+	for (auto itr = ++params.begin(); itr != params.end(); itr++) {
+		newParams.push_back(*itr);
+		newParams.push_back(std::to_string(kDefaultKeyPressTime));
+	}
+	Press(newParams);
+}
+
+void CustomCommandRunner::HoldKey(const std::vector<std::string> &params) {
+	for (auto itr = ++params.begin(); itr != params.end(); itr++) {
+		uint32_t key = GetKeyScanCode(*itr);
+		if (key != 0) {
+			input.KeyDown(key);
+		}
+	}
+}
+
+void CustomCommandRunner::ReleaseKey(const std::vector<std::string> &params) {
+	for (auto itr = ++params.begin(); itr != params.end(); itr++) {
+		uint32_t key = GetKeyScanCode(*itr);
+		if (key != 0) {
+			input.KeyUp(key);
+		}
+	}
+}
+
+void CustomCommandRunner::Sleep(const std::vector<std::string> &params) {
+	if (params.size() < 2) {
+		return;
+	}
+
+	const std::string &time = params[1];
+	long millisecond = 0;
+
+	if (time.size() > 2 && time[0] == '0' && (time[1] == 'x' || time[1] == 'X')) {
+		// hex
+		millisecond = strtol(time.substr(2).c_str(), NULL, 16);
+	}
+	else if ('0' <= time[0] && time[0] <= '9') {
+		// dec
+		millisecond = strtol(time.c_str(), NULL, 10);
+	}
+
+	if (millisecond > 0) {
+		clock.SleepMilliseconds((uint32_t)millisecond);
+	}
+}
+
+void CustomCommandRunner::SwitchWindow(const std::vector<std::string> &params) {
+	std::string windowTitle;
+
+	if (params.size() >= 2) {
+		windowTitle = params[1];
+		for (size_t i = 2; i < params.size(); i++) {
+			windowTitle += ' ';
+			windowTitle += params[i];
+		}
+	}
+
+	if (!windows.ActivateWindow(windowTitle)) {
+		Log::info("Cannot find windows with title/executable: " + windowTitle);
+	}
+}
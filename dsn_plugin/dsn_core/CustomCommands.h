@@ -0,0 +1,178 @@
+#pragma once
+#include "Platform.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Key releases of a press command, sorted by the milliseconds since the keys were pressed
+typedef std::map<uint32_t /*time*/, uint32_t /*key*/> KeyReleaseSchedule;
+
+// Compute the keys to press and when to release them for the parameters of a press command.
+// Keys with an unknown name or a zero time are skipped.
+void BuildPressSchedule(std::vector<std::string> params, std::vector<uint32_t> &keyDown, KeyReleaseSchedule &keyUp);
+
+// A command of the voice command list, parsed once by CustomCommandRunner::Parse() so it can be run many times
+// (see CommandTable.h)
+struct ParsedCommand {
+	std::string text;                 // as received, what the Skyrim console runs
+	std::vector<std::string> params;  // the name and parameters of a custom command, empty otherwise
+	int custom = -1;                  // index of the custom command, -1 for a Skyrim console command
+
+	bool IsCustom() const { return custom >= 0; }
+};
+typedef std::shared_ptr<const ParsedCommand> ParsedCommandPtr;
+
+// Custom commands of the voice command list that are run by the plugin instead of the Skyrim console
+class CustomCommandRunner
+{
+public:
+	static const uint32_t kDefaultKeyPressTime = 50;
+
+	CustomCommandRunner(IClock &clock, IInputSink &input, IWindowLocator &windows);
+
+	// Try run a custom command.
+	// Returns true if the command was running successful.
+	// Returns false if the command is not a custom command and the caller
+	// should add the command to another queue.
+	bool TryRun(const std::string &command);
+	// Same as TryRun() for a command parsed before
+	bool Run(const ParsedCommand &command);
+
+	// Split a command and look up its custom command, without running it
+	static ParsedCommand Parse(std::string command);
+
+	//
+	// Add a new command:
+	//         press <key name or DirectInput scan code> [millisecond] ...
+	//
+	// Description:
+	//         Simulate pressing the specified key the specified milliseconds.
+	//         Used to cast skills or dragon shouts or do other actions.
+	//         If time is omitted, the time will be set as kDefaultKeyPressTime.
+    //
+	// Tips:
+	//      1. If you want to use scan code 0-9, please add the prefix 0x.
+	//         A single digit without 0x prefix will be considered a digit key instead of a key code.
+	//         Exampke: 0x01 is esc, but 1 is the number key 1.
+	//
+	//      2. Only the currently active window can receive the simulated key.
+	//         Activate the Skyrim window by calling switchwindow command if necessary.
+	//
+	//      3. Only one key can be represented when the time is omitted.
+	//         To tap more keys without time, use the tapkey command.
+	//
+	//      4. Mouse event is supported. Use the following key names:
+	//             leftmousebutton  rightmousebutton  middlemousebutton
+	//             mousewheelup     mousewheeldown
+	//             mousebutton4     mousebutton5
+	//         However, the cursor must be inside the Skyrim window when simulating a mouse click,
+	//         otherwise the other window will receive the click event instead of Skyrim.
+	//
+	//
+	// Reference:
+	//         Windows DirectInput scan codes:
+    //                 https://www.creationkit.com/index.php?title=Input_Script#DXScanCodes
+	//         Avaliable key names:
+    //                 https://github.com/YihaoPeng/DragonbornSpeaksNaturally/blob/master/dsn_plugin/dsn_core/KeyScanCode.cpp
+	//
+	// Example:
+	//         press m
+	//         press Z 1000
+	//         press 44 50
+	//         press 0x2C 100
+	//         press esc
+	//
+	//         ; Press 3 keys at the same time (ctrl + alt + a):
+	//         press  ctrl 500  alt 500  a 400
+	//
+	//         ; left hand magic
+	//         press  leftmousebutton 1000
+	//
+	void Press(const std::vector<std::string> &params);
+
+	//
+	// Add a new command:
+	//         tapkey <key name or DirectInput Scan Code> ...
+	//
+	// Description:
+	//         It's a shortcut to the press command (All pressing time are set to kDefaultKeyPressTime milliseconds).
+	//
+	// Example:
+	//         ; Press 3 keys at the same time (ctrl + alt + a):
+	//         tapkey ctrl alt a
+	//
+	void TapKey(const std::vector<std::string> &params);
+
+	//
+	// Add two new command:
+	//         holdkey <key name or DirectInput Scan Code> ...
+	//         releasekey <key name or DirectInput Scan Code> ...
+	//
+	// Description:
+	//         Manual control the press and release of keys.
+	//
+	// Example:
+	//         ; typing with shift hold:
+	//         tapkey ~; sleep 100; holdkey shift; tapkey t e; tapkey s t; releasekey shift; sleep 100; tapkey t e; tapkey s t
+	//
+	//         ; casting magic with double hands
+	//         holdkey leftmousebutton; sleep 1000; holdkey rightmousebutton; sleep 5000; releasekey leftmousebutton; sleep 3000; releasekey rightmousebutton
+	//
+	void HoldKey(const std::vector<std::string> &params);
+	void ReleaseKey(const std::vector<std::string> &params);
+
+	//
+	// Add a new command:
+	//        sleep millisecond
+	// 
+	// Description:
+	//        Delays the subsequent commands the specified milliseconds.
+	//        Used to form an automatic action script with the press command.
+	//        Both custom commands and Skyrim commands can be delayed.
+	// 
+	// Example:
+	//         sleep 5000
+	//         press z; sleep 1000; press LeftMouseButton 2000
+	//         press ctrl; sleep 5000; press ctrl
+	//
+	//         ; Casting two dragon shouts one after another:
+	//         player.cast 0003f9ed player voice; sleep 3000; player.cast 00013f3a player voice
+	//
+	void Sleep(const std::vector<std::string> &params);
+
+	//
+	// Add a new command:
+	//         switchwindow [window title|executable name]
+	// 
+	// Description:
+	//         Activate the specified window.
+	//         Used to switch to the correct window before running the press command.
+	//         Omitting the parameters will activate the current Skyrim window.
+	//
+	// TODO:
+	//         Move the mouse cursor to the center of the active window.
+	// 
+	// Example:
+	//         switchwindow
+	//         switchwindow Notepad++
+	//         switchwindow notepad.exe
+	//
+	//         ; Activate the Skyrim window and type in the console:
+	//         switchwindow; sleep 50; tapkey ~; sleep 50; tapkey s a v e enter; sleep 50; tapkey ~
+	//
+	void SwitchWindow(const std::vector<std::string> &params);
+
+private:
+	typedef void (CustomCommandRunner::*CustomCommand)(const std::vector<std::string> &params);
+	struct CustomCommandEntry {
+		const char *name;
+		CustomCommand func;
+	};
+	static const CustomCommandEntry customCmdList[];
+
+	IClock &clock;
+	IInputSink &input;
+	IWindowLocator &windows;
+};
@@ -0,0 +1,28 @@
+#include "DialogueArena.h"
+#include <algorithm>
+
+DialogueArena::DialogueArena(size_t blockSize) : blockSize(blockSize) {
+}
+
+char *DialogueArena::Allocate(size_t size) {
+	for (; currentBlock < blocks.size(); currentBlock++, used = 0) {
+		Block &block = blocks[currentBlock];
+		if (block.size - used >= size) {
+			char *data = block.data.get() + used;
+			used += size;
+			return data;
+		}
+	}
+
+	// currentBlock == blocks.size(), the new block becomes the current one
+	size_t newSize = std::max(blockSize, size);
+	blocks.push_back(Block{ std::unique_ptr<char[]>(new char[newSize]), newSize });
+	blockAllocations++;
+	used = size;
+	return blocks.back().data.get();
+}
+
+void DialogueArena::Reset() {
+	currentBlock = 0;
+	used = 0;
+}
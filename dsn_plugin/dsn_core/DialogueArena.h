@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Bump allocator for the messages built when a dialogue menu opens (see BuildStartDialogue in SpeechProtocol.h).
+// Reset() releases everything at once but keeps the memory, so once the arena has grown to the size of
+// the largest dialogue, building a message does not allocate from the heap.
+class DialogueArena
+{
+public:
+	static const size_t kDefaultBlockSize = 16 * 1024;
+
+	explicit DialogueArena(size_t blockSize = kDefaultBlockSize);
+
+	// Returns `size` bytes (not aligned) valid until Reset()
+	char *Allocate(size_t size);
+	void Reset();
+
+	// Number of blocks allocated from the heap since the arena was created
+	uint64_t BlockAllocations() const { return blockAllocations; }
+
+private:
+	struct Block {
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	size_t blockSize;
+	std::vector<Block> blocks;
+	size_t currentBlock = 0;  // index of the block being filled
+	size_t used = 0;          // bytes used in the current block
+	uint64_t blockAllocations = 0;
+};
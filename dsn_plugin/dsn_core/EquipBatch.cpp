@@ -0,0 +1,18 @@
+#include "EquipBatch.h"
+#include <algorithm>
+
+size_t CoalesceEquips(std::vector<PendingEquip> &batch) {
+	// Walk backwards, collecting the slots taken by the later commands
+	EquipSlotMask taken = 0;
+	for (auto itr = batch.rbegin(); itr != batch.rend(); itr++) {
+		itr->superseded = itr->slots != 0 && (itr->slots & ~taken) == 0;
+		taken |= itr->slots;
+	}
+
+	auto end = std::remove_if(batch.begin(), batch.end(), [](const PendingEquip &equip) {
+		return equip.superseded;
+	});
+	size_t dropped = batch.end() - end;
+	batch.erase(end, batch.end());
+	return dropped;
+}
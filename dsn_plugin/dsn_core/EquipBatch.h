@@ -0,0 +1,28 @@
+#pragma once
+#include "EquipParser.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Equipment slots taken by an equip command.
+// The low 32 bits are the biped slots of armors (BGSBipedObjectForm::GetSlotMask()).
+typedef uint64_t EquipSlotMask;
+
+static const EquipSlotMask kEquipSlot_Biped     = 0xFFFFFFFFULL;
+static const EquipSlotMask kEquipSlot_RightHand = 1ULL << 32;
+static const EquipSlotMask kEquipSlot_LeftHand  = 1ULL << 33;
+static const EquipSlotMask kEquipSlot_Voice     = 1ULL << 34;
+static const EquipSlotMask kEquipSlot_Ammo      = 1ULL << 35;
+
+struct PendingEquip {
+	EquipItem item;
+	EquipSlotMask slots; // 0 if unknown, such commands are never dropped
+	void *form;          // resolved form, opaque to the batch
+	bool superseded;
+};
+
+// Drop the commands of a batch whose slots are all taken by later commands of the same batch,
+// so only the last equip to a hand, an armor slot or the voice slot is applied.
+// The order of the remaining commands is kept.
+// Returns the number of dropped commands.
+size_t CoalesceEquips(std::vector<PendingEquip> &batch);
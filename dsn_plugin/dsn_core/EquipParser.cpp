@@ -0,0 +1,67 @@
+#include "EquipParser.h"
+#include <charconv>
+
+// Consume the next ';' separated field of `rest` and parse it as a decimal integer.
+template <typename T>
+static EquipParseResult parseField(std::string_view &rest, T &out, bool isLastField) {
+	size_t sep = rest.find(';');
+	std::string_view field = rest.substr(0, sep);
+
+	if (sep == std::string_view::npos) {
+		if (!isLastField) {
+			return kEquipParse_MissingField;
+		}
+		rest = std::string_view();
+	}
+	else {
+		if (isLastField) {
+			return kEquipParse_TrailingData;
+		}
+		rest.remove_prefix(sep + 1);
+	}
+
+	if (field.empty()) {
+		return kEquipParse_MissingField;
+	}
+
+	const char *end = field.data() + field.size();
+	std::from_chars_result res = std::from_chars(field.data(), end, out);
+	if (res.ec == std::errc::result_out_of_range) {
+		return kEquipParse_OutOfRange;
+	}
+	if (res.ec != std::errc() || res.ptr != end) {
+		return kEquipParse_InvalidNumber;
+	}
+	return kEquipParse_Ok;
+}
+
+EquipParseResult ParseEquipItem(std::string_view payload, EquipItem &item) {
+	EquipItem parsed;
+	EquipParseResult result;
+
+	// payload: <formId>;<itemId>;<itemType>;<hand>
+	if ((result = parseField(payload, parsed.TESFormId, false)) != kEquipParse_Ok ||
+		(result = parseField(payload, parsed.itemId, false)) != kEquipParse_Ok ||
+		(result = parseField(payload, parsed.itemType, false)) != kEquipParse_Ok ||
+		(result = parseField(payload, parsed.hand, true)) != kEquipParse_Ok) {
+		return result;
+	}
+
+	if (parsed.itemType < 1 || parsed.itemType > 3 || parsed.hand < 0 || parsed.hand > 2) {
+		return kEquipParse_OutOfRange;
+	}
+
+	item = parsed;
+	return kEquipParse_Ok;
+}
+
+const char * EquipParseResultToString(EquipParseResult result) {
+	switch (result) {
+	case kEquipParse_Ok:            return "ok";
+	case kEquipParse_MissingField:  return "missing field";
+	case kEquipParse_InvalidNumber: return "invalid number";
+	case kEquipParse_OutOfRange:    return "out of range";
+	case kEquipParse_TrailingData:  return "trailing data";
+	}
+	return "unknown";
+}
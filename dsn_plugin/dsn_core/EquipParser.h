@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+// Parsed payload of an "EQUIP|<formId>;<itemId>;<itemType>;<hand>" message
+struct EquipItem {
+	uint32_t TESFormId;
+	int32_t itemId;
+	uint8_t itemType; // 1 = item, 2 = spell, 3 = shout
+	int32_t hand; // 0 = no hand specified, 1 = right hand, 2 = left hand
+};
+
+enum EquipParseResult
+{
+	kEquipParse_Ok = 0,
+	kEquipParse_MissingField,   // fewer than 4 fields, or an empty field
+	kEquipParse_InvalidNumber,  // a field is not a decimal integer
+	kEquipParse_OutOfRange,     // a number does not fit its field, or an unknown item type / hand
+	kEquipParse_TrailingData    // more than 4 fields
+};
+
+// Parse the payload of an EQUIP message (the part after "EQUIP|").
+// Does not allocate. `item` is only written when kEquipParse_Ok is returned.
+EquipParseResult ParseEquipItem(std::string_view payload, EquipItem &item);
+
+const char * EquipParseResultToString(EquipParseResult result);
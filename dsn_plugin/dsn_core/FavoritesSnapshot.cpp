@@ -0,0 +1,55 @@
+#include "FavoritesSnapshot.h"
+#include <array>
+#include <charconv>
+
+static std::array<uint32_t, 256> makeCRC32Table() {
+	std::array<uint32_t, 256> table;
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+		}
+		table[i] = crc;
+	}
+	return table;
+}
+
+uint32_t FavoritesCRC32(const char *str, uint32_t start) {
+	static const std::array<uint32_t, 256> table = makeCRC32Table();
+
+	uint32_t result = ~start;
+	for (const unsigned char *c = (const unsigned char *)str; *c; c++) {
+		result = (result >> 8) ^ table[(result & 0xFF) ^ *c];
+	}
+	return ~result;
+}
+
+int32_t CalcFavoriteItemId(const char *name, uint32_t formId) {
+	if (!name) {
+		return 0;
+	}
+	return (int32_t)FavoritesCRC32(name, formId & 0x00FFFFFF);
+}
+
+template <typename T>
+static void appendNumber(std::string &out, T value) {
+	char buf[16];
+	std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), value);
+	out.append(buf, res.ptr);
+}
+
+void BuildFavoritesCommand(const std::vector<FavoriteMenuItem> &favorites, std::string &command) {
+	command = "FAVORITES";
+	for (const FavoriteMenuItem &favorite : favorites) {
+		command += '|';
+		command += favorite.fullname;
+		command += ',';
+		appendNumber(command, favorite.TESFormId);
+		command += ',';
+		appendNumber(command, favorite.itemId);
+		command += ',';
+		command += favorite.isHanded ? '1' : '0';
+		command += ',';
+		appendNumber(command, (unsigned int)favorite.itemType);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct FavoriteMenuItem {
+	uint32_t TESFormId;
+	int32_t itemId;
+	std::string fullname;
+	uint8_t itemType; // 1 = item, 2 = spell, 3 = shout
+	bool isHanded;	// True if user must specify "left" or "right" in equip commands
+};
+
+// Same CRC32 as SKSE's HashUtil::CRC32, which computes the item ids of the favorites menu
+uint32_t FavoritesCRC32(const char *str, uint32_t start = 0);
+
+// Item id of an inventory item as shown by the favorites menu, 0 if the item has no name
+int32_t CalcFavoriteItemId(const char *name, uint32_t formId);
+
+// Serialize the favorites into "FAVORITES|<name>,<formId>,<itemId>,<isHanded>,<itemType>|..."
+void BuildFavoritesCommand(const std::vector<FavoriteMenuItem> &favorites, std::string &command);
+
+// Append the hotkeyed items of an inventory entry to `favorites`.
+//
+// The game structures are accessed through `Traits` so the same code runs on SKSE's
+// InventoryEntryData in the plugin and on synthetic structures in the benchmarks:
+//
+//   typedef ... Entry;      // InventoryEntryData
+//   typedef ... Form;       // TESForm
+//   typedef ... ExtraList;  // BaseExtraList
+//   static Form * GetForm(Entry *entry);
+//   static uint32_t GetFormId(Form *form);
+//   static const char * GetFullName(Form *form);         // TESFullName, may be NULL
+//   static bool IsSingleHanded(Form *form);
+//   static ExtraList * GetNthExtraList(Entry *entry, int32_t n);  // NULL past the end
+//   static bool HasHotkey(ExtraList *extraList);         // ExtraHotkey
+//   static const char * GetDisplayName(ExtraList *extraList, Form *form);  // may be NULL
+//   static const char * GetTextDisplayName(ExtraList *extraList);  // ExtraTextDisplayData, may be NULL
+template <typename Traits>
+void ExtractFavorites(typename Traits::Entry *entry, std::vector<FavoriteMenuItem> &favorites) {
+	typename Traits::Form *form = Traits::GetForm(entry);
+	typename Traits::ExtraList *extraList = Traits::GetNthExtraList(entry, 0);
+	if (!form || !extraList) {
+		return;
+	}
+
+	const char *baseName = Traits::GetFullName(form);
+	uint32_t formId = Traits::GetFormId(form);
+	bool isHanded = Traits::IsSingleHanded(form);
+
+	for (int32_t n = 1; extraList; extraList = Traits::GetNthExtraList(entry, n++)) {
+		if (!Traits::HasHotkey(extraList)) {
+			continue;
+		}
+
+		// Renamed (e.g. enchanted by the player) items keep the id of their display name
+		const char *displayName = Traits::GetDisplayName(extraList, form);
+		const char *idName = displayName ? displayName : baseName;
+		const char *textDisplayName = Traits::GetTextDisplayName(extraList);
+		const char *name = textDisplayName ? textDisplayName : idName;
+
+		FavoriteMenuItem entry = {
+			formId,
+			CalcFavoriteItemId(idName, formId),
+			name ? name : "",
+			1, // Equipment
+			isHanded };
+
+		favorites.push_back(entry);
+	}
+}
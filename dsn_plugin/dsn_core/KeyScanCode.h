@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Key codes above 255 are mouse buttons and the mouse wheel
+static const uint32_t KEY_SCAN_CODE_MOUSE_EVENT_BEGIN    = 256;
+static const uint32_t KEY_SCAN_CODE_MOUSE_EVENT_END      = 265;
+static const uint32_t KEY_SCAN_CODE_MOUSE_X_BUTTON_BEGIN = 259;
+static const uint32_t KEY_SCAN_CODE_MOUSE_WHEEL_UP       = 264;
+static const uint32_t KEY_SCAN_CODE_MOUSE_WHEEL_DOWN     = 265;
+
+// Convert a key name (see KeyScanCode.cpp), a hex ("0x2C") or a decimal ("44") scan code
+// to a DirectInput scan code. Returns 0 for an unknown key.
+uint32_t GetKeyScanCode(std::string key);
@@ -0,0 +1,91 @@
+#include "ListenState.h"
+#include <algorithm>
+
+const char *const ListenState::kDefaultPausingMenus = "Loading Menu,Main Menu,Journal Menu,Console,Credits Menu,Mod Manager Menu";
+
+static std::string_view trim(std::string_view s) {
+	size_t begin = s.find_first_not_of(" \t");
+	if (begin == std::string_view::npos) {
+		return std::string_view();
+	}
+	return s.substr(begin, s.find_last_not_of(" \t") - begin + 1);
+}
+
+void ListenState::SetPausingMenus(std::string_view menus) {
+	std::lock_guard<std::mutex> guard(lock);
+	pausingMenus.clear();
+	while (!menus.empty()) {
+		size_t sep = menus.find(',');
+		std::string_view menu = trim(menus.substr(0, sep));
+		if (!menu.empty()) {
+			pausingMenus.emplace_back(menu);
+		}
+		menus = sep == std::string_view::npos ? std::string_view() : menus.substr(sep + 1);
+	}
+}
+
+void ListenState::SetPushToTalk(bool enabled, uint32_t releaseDelay) {
+	std::lock_guard<std::mutex> guard(lock);
+	pushToTalk = enabled;
+	this->releaseDelay = releaseDelay;
+	talking = false;
+}
+
+bool ListenState::MenuOpenClose(std::string_view menuName, bool opening, std::string &line) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (std::find(pausingMenus.begin(), pausingMenus.end(), menuName) == pausingMenus.end()) {
+		return false;
+	}
+
+	auto open = std::find(openMenus.begin(), openMenus.end(), menuName);
+	if (opening && open == openMenus.end()) {
+		openMenus.emplace_back(menuName);
+	}
+	else if (!opening && open != openMenus.end()) {
+		// A close without an open is ignored, e.g. the loading screen of the game's start
+		openMenus.erase(open);
+	}
+	return Update(line);
+}
+
+bool ListenState::PushToTalk(bool held, uint64_t now, std::string &line) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (!pushToTalk) {
+		return false;
+	}
+
+	if (held) {
+		talking = true;
+		releasedAt = 0;
+	}
+	else if (talking) {
+		if (releasedAt == 0) {
+			releasedAt = now;
+		}
+		talking = now - releasedAt < releaseDelay;
+	}
+	return Update(line);
+}
+
+bool ListenState::IsListening() {
+	std::lock_guard<std::mutex> guard(lock);
+	return listening;
+}
+
+bool ListenState::Update(std::string &line) {
+	bool listen = openMenus.empty() && (!pushToTalk || talking);
+	if (listen == listening) {
+		return false;
+	}
+
+	listening = listen;
+	if (listen) {
+		line = "LISTEN_RESUME";
+	}
+	else {
+		// The reason is only logged by the service
+		line = "LISTEN_PAUSE|";
+		line.append(openMenus.empty() ? "push-to-talk" : openMenus.front());
+	}
+	return true;
+}
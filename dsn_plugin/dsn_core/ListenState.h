@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Whether the speech recognition service listens to the microphone. The recognition is paused while a menu where
+// voice commands are useless is open (loading screens, the main menu...) and, with push-to-talk, while the key
+// is not held. The service stops its recognizer on LISTEN_PAUSE and starts it again on LISTEN_RESUME, without
+// reloading its grammars (see SpeechProtocol.h).
+//
+// Thread-safe: the menu events and the game thread both update it. The changes return the line to send.
+class ListenState
+{
+public:
+	// Menus paused by default, see pauseInMenus in the [SpeechRecognition] section of the ini
+	static const char *const kDefaultPausingMenus;
+	static const uint32_t kDefaultReleaseDelay = 500;
+
+	// Comma separated names of the menus that pause the recognition while they are open
+	void SetPausingMenus(std::string_view menus);
+	// Only listen while the push-to-talk key is held and `releaseDelay` milliseconds after its release,
+	// so the end of a phrase is not cut
+	void SetPushToTalk(bool enabled, uint32_t releaseDelay = kDefaultReleaseDelay);
+
+	// A menu opened or closed. Returns true with the line in `line` when listening changed.
+	bool MenuOpenClose(std::string_view menuName, bool opening, std::string &line);
+	// Called once per frame with the state of the push-to-talk key. Returns true with the line in `line`
+	// when listening changed.
+	bool PushToTalk(bool held, uint64_t now, std::string &line);
+
+	bool IsListening();
+
+private:
+	// Must be called with lock held
+	bool Update(std::string &line);
+
+	std::mutex lock;
+	std::vector<std::string> pausingMenus;
+	std::vector<std::string> openMenus;  // the open pausing menus
+	bool pushToTalk = false;
+	uint32_t releaseDelay = kDefaultReleaseDelay;
+	bool talking = false;
+	uint64_t releasedAt = 0;
+	bool listening = true;  // the service listens from its start
+};
@@ -2,8 +2,6 @@
 #include <sstream>
 #include <fstream>
 
-static bool LOG_ENABLED = true;
-
 Log::Log()
 {
 }
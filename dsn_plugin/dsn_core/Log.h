@@ -1,5 +1,5 @@
 #pragma once
-#include "common/IPrefix.h"
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 
@@ -0,0 +1,165 @@
+#include "OutboundWriter.h"
+#include "Log.h"
+
+static const size_t kMaxSpareLines = 16;
+
+OutboundWriter::OutboundWriter(IClock &clock, WrittenHandler onWritten) : clock(clock), onWritten(onWritten) {
+}
+
+OutboundWriter::~OutboundWriter() {
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		stopping = true;
+		queueChanged.notify_all();
+	}
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+void OutboundWriter::SetPipe(IPipe *pipe) {
+	std::unique_lock<std::mutex> lock(queueLock);
+	queueChanged.wait(lock, [this] { return !writing; });
+	this->pipe = pipe;
+	queue.clear();
+	dialogueOpenSent = false;
+	queueChanged.notify_all();
+
+	if (pipe && !thread.joinable()) {
+		thread = std::thread(&OutboundWriter::Run, this);
+	}
+}
+
+OutboundWriter::LineKind OutboundWriter::GetLineKind(std::string_view line) {
+	std::string_view message = line.substr(0, line.find('|'));
+	if (message == "FAVORITES")
+		return kLine_Favorites;
+	if (message == "START_DIALOGUE")
+		return kLine_StartDialogue;
+	if (message == "STOP_DIALOGUE")
+		return kLine_StopDialogue;
+	return kLine_Other;
+}
+
+bool OutboundWriter::IsDialogueOpen() const {
+	for (size_t i = queue.size(); i-- > 0;) {
+		if (queue[i].kind == kLine_StartDialogue)
+			return true;
+		if (queue[i].kind == kLine_StopDialogue)
+			return false;
+	}
+	return dialogueOpenSent;
+}
+
+bool OutboundWriter::Enqueue(std::string_view line) {
+	std::lock_guard<std::mutex> lock(queueLock);
+	if (!pipe) {
+		return false;
+	}
+
+	LineKind kind = GetLineKind(line);
+	if (kind == kLine_Favorites) {
+		for (QueuedLine &queued : queue) {
+			if (queued.kind == kLine_Favorites) {
+				queued.data.assign(line);
+				queued.data.push_back('\n');
+				superseded++;
+				return true;
+			}
+		}
+	}
+	else if (kind == kLine_StartDialogue || kind == kLine_StopDialogue) {
+		// The unsent START_DIALOGUE of the dialogue this line replaces or ends
+		for (size_t i = queue.size(); i-- > 0;) {
+			if (queue[i].kind == kLine_StopDialogue)
+				break;
+			if (queue[i].kind == kLine_StartDialogue) {
+				if (spare.size() < kMaxSpareLines) {
+					spare.push_back(std::move(queue[i].data));
+				}
+				queue.erase(queue.begin() + i);
+				superseded++;
+				break;
+			}
+		}
+		if (kind == kLine_StopDialogue && !IsDialogueOpen()) {
+			superseded++;
+			return true;
+		}
+	}
+
+	QueuedLine queued;
+	queued.kind = kind;
+	if (!spare.empty()) {
+		queued.data = std::move(spare.back());
+		spare.pop_back();
+	}
+	queued.data.assign(line);
+	queued.data.push_back('\n');
+	queue.push_back(std::move(queued));
+
+	if (queue.size() > maxDepth) {
+		maxDepth = queue.size();
+	}
+	queueChanged.notify_all();
+	return true;
+}
+
+void OutboundWriter::Flush() {
+	std::unique_lock<std::mutex> lock(queueLock);
+	queueChanged.wait(lock, [this] { return !pipe || (queue.empty() && !writing); });
+}
+
+OutboundWriter::Stats OutboundWriter::GetStats() {
+	std::lock_guard<std::mutex> lock(queueLock);
+	Stats stats;
+	stats.depth = queue.size();
+	stats.maxDepth = maxDepth;
+	stats.written = written;
+	stats.maxWriteTime = maxWriteTime;
+	stats.superseded = superseded;
+	return stats;
+}
+
+void OutboundWriter::Run() {
+	std::unique_lock<std::mutex> lock(queueLock);
+	for (;;) {
+		queueChanged.wait(lock, [this] { return stopping || (pipe && !queue.empty()); });
+		if (stopping) {
+			return;
+		}
+
+		std::string line = std::move(queue.front().data);
+		LineKind kind = queue.front().kind;
+		queue.pop_front();
+		if (kind == kLine_StartDialogue || kind == kLine_StopDialogue) {
+			dialogueOpenSent = kind == kLine_StartDialogue;
+		}
+		IPipe *target = pipe;
+		size_t depth = queue.size();
+		writing = true;
+		lock.unlock();
+
+		uint64_t start = clock.NowMilliseconds();
+		target->Write(line.data(), line.size());
+		uint64_t writeTime = clock.NowMilliseconds() - start;
+		if (writeTime >= kSlowWriteThreshold) {
+			Log::info("Writing to the speech recognition service blocked for " + std::to_string(writeTime)
+				+ " ms, " + std::to_string(depth) + " lines queued");
+		}
+		if (onWritten) {
+			onWritten(std::string_view(line.data(), line.size() - 1));
+		}
+
+		lock.lock();
+		writing = false;
+		written++;
+		if (writeTime > maxWriteTime) {
+			maxWriteTime = writeTime;
+		}
+		if (spare.size() < kMaxSpareLines) {
+			spare.push_back(std::move(line));
+		}
+		queueChanged.notify_all();
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "Platform.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Queue of the lines sent to the speech recognition service, written to the pipe by a dedicated thread.
+// The game threads only enqueue, so they do not freeze when the service is busy and the pipe buffer is full.
+//
+// Lines that became stale before being written are superseded, to spare the service rebuilding grammars:
+//  - a FAVORITES snapshot replaces the unsent older one,
+//  - a START_DIALOGUE or STOP_DIALOGUE removes the unsent START_DIALOGUE of the dialogue it replaces or ends,
+//    and a STOP_DIALOGUE is dropped when the service has no dialogue open once that START_DIALOGUE is removed.
+class OutboundWriter
+{
+public:
+	// Writes blocking longer than this (milliseconds) are logged
+	static const uint32_t kSlowWriteThreshold = 100;
+
+	struct Stats {
+		size_t depth;           // lines waiting to be written
+		size_t maxDepth;        // highest depth since the writer was created
+		uint64_t written;       // lines written
+		uint64_t maxWriteTime;  // longest time a write blocked, in milliseconds
+		uint64_t superseded;    // lines dropped or replaced before being written
+	};
+
+	// Called on the writer thread with each line written (without the '\n')
+	typedef std::function<void(std::string_view line)> WrittenHandler;
+
+	explicit OutboundWriter(IClock &clock, WrittenHandler onWritten = nullptr);
+	~OutboundWriter();
+
+	// Set the pipe the lines are written to, or NULL when the service is gone. Waits for the line being written,
+	// the queued lines are dropped when the pipe changes. The writer thread is started with the first pipe.
+	void SetPipe(IPipe *pipe);
+
+	// Queue a line, returns false (and drops it) when there is no pipe
+	bool Enqueue(std::string_view line);
+
+	// Wait until every queued line is written, or the pipe is removed
+	void Flush();
+
+	Stats GetStats();
+
+private:
+	enum LineKind
+	{
+		kLine_Other = 0,
+		kLine_Favorites,
+		kLine_StartDialogue,
+		kLine_StopDialogue
+	};
+
+	struct QueuedLine {
+		LineKind kind;
+		std::string data;  // the line with its '\n'
+	};
+
+	static LineKind GetLineKind(std::string_view line);
+	// Whether the service has a dialogue open once the queued lines are written
+	bool IsDialogueOpen() const;
+	void Run();
+
+	IClock &clock;
+	WrittenHandler onWritten;
+
+	std::mutex queueLock;
+	std::condition_variable queueChanged;
+	std::deque<QueuedLine> queue;
+	std::vector<std::string> spare;  // written lines, reused to avoid allocating a string per line
+	IPipe *pipe = nullptr;
+	bool dialogueOpenSent = false;   // the last dialogue line taken by the writer thread is a START_DIALOGUE
+	bool writing = false;
+	bool stopping = false;
+	std::thread thread;
+
+	size_t maxDepth = 0;
+	uint64_t written = 0;
+	uint64_t maxWriteTime = 0;
+	uint64_t superseded = 0;
+};
@@ -0,0 +1,25 @@
+#include "PhraseEventQueue.h"
+
+const size_t PhraseEventQueue::kMaxQueued;
+
+void PhraseEventQueue::Push(int id, float confidence, std::string_view phrase, uint64_t queuedAt) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (queued.size() >= kMaxQueued) {
+		queued.erase(queued.begin());
+		dropped++;
+	}
+	queued.push_back({ id, confidence, std::string(phrase), queuedAt });
+}
+
+size_t PhraseEventQueue::TakeBatch(std::vector<PhraseEvent> &batch) {
+	batch.clear();
+	std::lock_guard<std::mutex> guard(lock);
+	// The batch's buffer is reused for the next frame's events
+	queued.swap(batch);
+	return batch.size();
+}
+
+uint64_t PhraseEventQueue::Dropped() {
+	std::lock_guard<std::mutex> guard(lock);
+	return dropped;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Recognition of a phrase tagged in the [PapyrusEvents] section of the ini, sent to Papyrus scripts
+struct PhraseEvent {
+	int id;            // the id the phrase is tagged with
+	float confidence;  // of the recognition, 0 to 1
+	std::string phrase;
+	uint64_t queuedAt;
+};
+
+// Phrase events waiting for the game thread. Push() is called on the thread reading the service's output,
+// TakeBatch() once per frame on the game thread: the events of a frame are swapped out at once and sent together.
+class PhraseEventQueue
+{
+public:
+	// The oldest events are dropped beyond, e.g. when the game thread does not run while the game is paused
+	static const size_t kMaxQueued = 256;
+
+	void Push(int id, float confidence, std::string_view phrase, uint64_t queuedAt);
+
+	// Move the queued events to `batch`, which is cleared first. Returns their count.
+	size_t TakeBatch(std::vector<PhraseEvent> &batch);
+
+	uint64_t Dropped();
+
+private:
+	std::mutex lock;
+	std::vector<PhraseEvent> queued;
+	uint64_t dropped = 0;
+};
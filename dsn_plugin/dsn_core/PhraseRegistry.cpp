@@ -0,0 +1,74 @@
+#include "PhraseRegistry.h"
+
+uint32_t PhraseRegistry::Register(std::string_view phrase, DSN_PhraseCallback callback, void *userData) {
+	// The phrase is a field of a protocol line
+	std::string text(phrase);
+	for (char &c : text) {
+		if (c == '|' || c == '\r' || c == '\n') {
+			c = ' ';
+		}
+	}
+	size_t first = text.find_first_not_of(' ');
+	if (first == std::string::npos || !callback) {
+		return 0;
+	}
+	text = text.substr(first, text.find_last_not_of(' ') - first + 1);
+
+	std::lock_guard<std::mutex> guard(lock);
+	uint32_t id = ++lastId;
+	entries[id] = { callback, userData };
+	pendingRegistrations.append("|").append(std::to_string(id)).append("|").append(text);
+	pending = true;
+	return id;
+}
+
+bool PhraseRegistry::Unregister(uint32_t id) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (entries.erase(id) == 0) {
+		return false;
+	}
+	pendingUnregistrations.append("|").append(std::to_string(id));
+	pending = true;
+	return true;
+}
+
+void PhraseRegistry::TakePendingLines(std::vector<std::string> &lines) {
+	if (!pending) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+	if (!pendingRegistrations.empty()) {
+		lines.push_back("REGISTER_PHRASES" + pendingRegistrations);
+		pendingRegistrations.clear();
+	}
+	if (!pendingUnregistrations.empty()) {
+		lines.push_back("UNREGISTER_PHRASES" + pendingUnregistrations);
+		pendingUnregistrations.clear();
+	}
+	pending = false;
+}
+
+size_t PhraseRegistry::Deliver(const std::vector<uint32_t> &ids) {
+	size_t delivered = 0;
+	for (uint32_t id : ids) {
+		Entry entry;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			auto itr = entries.find(id);
+			if (itr == entries.end()) {
+				continue;
+			}
+			entry = itr->second;
+		}
+		// Without the lock, the callback may register or unregister phrases
+		entry.callback(id, entry.userData);
+		delivered++;
+	}
+	return delivered;
+}
+
+size_t PhraseRegistry::Size() {
+	std::lock_guard<std::mutex> guard(lock);
+	return entries.size();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "VoiceCommandApi.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Phrases registered by other plugins through the C API (see VoiceCommandApi.h).
+//
+// Registrations are batched: TakePendingLines() returns one REGISTER_PHRASES and one UNREGISTER_PHRASES line
+// (see SpeechProtocol.h) with the changes since its last call, the client sends them once per frame.
+// The service answers PHRASE|<id>, Deliver() then runs the callbacks on the game thread.
+class PhraseRegistry
+{
+public:
+	// Returns the id of the phrase, 0 if it is empty or has no callback
+	uint32_t Register(std::string_view phrase, DSN_PhraseCallback callback, void *userData);
+	bool Unregister(uint32_t id);
+
+	// Append the lines for the changes since the last call to `lines`, registrations first
+	void TakePendingLines(std::vector<std::string> &lines);
+
+	// Run the callbacks of the recognized phrases `ids`, the unregistered ones are skipped.
+	// Returns the number of callbacks run.
+	size_t Deliver(const std::vector<uint32_t> &ids);
+
+	size_t Size();
+
+private:
+	struct Entry {
+		DSN_PhraseCallback callback;
+		void *userData;
+	};
+
+	std::mutex lock;
+	std::unordered_map<uint32_t, Entry> entries;
+	uint32_t lastId = 0;
+	std::string pendingRegistrations;    // "|<id>|<phrase>" for each new phrase
+	std::string pendingUnregistrations;  // "|<id>" for each removed phrase
+	std::atomic<bool> pending{ false };  // checked every frame without the lock
+};
@@ -0,0 +1,12 @@
+#include "Platform.h"
+#include <chrono>
+#include <thread>
+
+uint64_t SteadyClock::NowMilliseconds() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SteadyClock::SleepMilliseconds(uint32_t milliseconds) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
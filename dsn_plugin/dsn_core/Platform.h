@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Thin interfaces to the operating system, so the code of dsn_core does not depend on Windows.
+// The implementations used in the game are in dsn_plugin/WindowsPlatform.h.
+
+class IClock
+{
+public:
+	virtual ~IClock() {}
+
+	// Monotonic time in milliseconds
+	virtual uint64_t NowMilliseconds() = 0;
+	virtual void SleepMilliseconds(uint32_t milliseconds) = 0;
+};
+
+// Receives simulated key presses (DirectInput scan codes, see KeyScanCode.h)
+class IInputSink
+{
+public:
+	virtual ~IInputSink() {}
+
+	virtual void KeyDown(uint32_t scanCode) = 0;
+	virtual void KeyUp(uint32_t scanCode) = 0;
+};
+
+// State of the keyboard and mouse buttons (DirectInput scan codes and mouse codes, see KeyScanCode.h)
+class IKeyState
+{
+public:
+	virtual ~IKeyState() {}
+
+	virtual bool IsKeyDown(uint32_t scanCode) = 0;
+};
+
+// Byte stream to and from the speech recognition service
+class IPipe
+{
+public:
+	virtual ~IPipe() {}
+
+	// Read at most `size` bytes.
+	// Returns the number of bytes read, 0 if no data is available yet or -1 if the pipe is closed.
+	virtual int Read(char *buffer, size_t size) = 0;
+	// Write all `size` bytes. Returns false if the pipe is closed.
+	virtual bool Write(const char *data, size_t size) = 0;
+};
+
+// Wakes a process waiting on a word of shared memory (see SharedMemoryPipe.h)
+class IRingSignal
+{
+public:
+	virtual ~IRingSignal() {}
+
+	// Wake the process waiting on `sequence`, after incrementing it
+	virtual void Wake(std::atomic<uint32_t> &sequence) = 0;
+	// Wait until woken, `sequence` is no longer `expected` or `timeout` milliseconds passed.
+	// Can return early.
+	virtual void Wait(std::atomic<uint32_t> &sequence, uint32_t expected, uint32_t timeout) = 0;
+};
+
+class IWindowLocator
+{
+public:
+	virtual ~IWindowLocator() {}
+
+	// Activate the main window of the process with the executable name `name`,
+	// or else the window with the title or class name `name`.
+	// An empty name activates the main window of the current process.
+	// Returns false if no window was found.
+	virtual bool ActivateWindow(const std::string &name) = 0;
+};
+
+// IClock on std::chrono::steady_clock
+class SteadyClock : public IClock
+{
+public:
+	uint64_t NowMilliseconds() override;
+	void SleepMilliseconds(uint32_t milliseconds) override;
+};
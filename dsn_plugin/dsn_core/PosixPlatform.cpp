@@ -0,0 +1,192 @@
+#include "PosixPlatform.h"
+#include <cerrno>
+#include <csignal>
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+PosixProcessPipe::~PosixProcessPipe() {
+	Stop();
+	if (stdOutRd >= 0) {
+		close(stdOutRd);
+	}
+}
+
+bool PosixProcessPipe::Start(const std::string &commandLine) {
+	int inPipe[2];
+	int outPipe[2];
+	if (pipe(inPipe) != 0) {
+		return false;
+	}
+	if (pipe(outPipe) != 0) {
+		close(inPipe[0]);
+		close(inPipe[1]);
+		return false;
+	}
+
+	// A write to an exited service must fail instead of killing the client
+	signal(SIGPIPE, SIG_IGN);
+
+	pid = fork();
+	if (pid == 0) {
+		dup2(inPipe[0], STDIN_FILENO);
+		dup2(outPipe[1], STDOUT_FILENO);
+		close(inPipe[0]);
+		close(inPipe[1]);
+		close(outPipe[0]);
+		close(outPipe[1]);
+		execl("/bin/sh", "sh", "-c", commandLine.c_str(), (char *)NULL);
+		_exit(127);
+	}
+
+	close(inPipe[0]);
+	close(outPipe[1]);
+	if (pid < 0) {
+		close(inPipe[1]);
+		close(outPipe[0]);
+		return false;
+	}
+
+	stdInWr = inPipe[1];
+	stdOutRd = outPipe[0];
+	fcntl(stdInWr, F_SETFD, FD_CLOEXEC);
+	fcntl(stdOutRd, F_SETFD, FD_CLOEXEC);
+	return true;
+}
+
+int PosixProcessPipe::Stop() {
+	if (stdInWr >= 0) {
+		close(stdInWr);
+		stdInWr = -1;
+	}
+
+	if (pid > 0) {
+		int status = 0;
+		if (waitpid(pid, &status, 0) == pid && WIFEXITED(status)) {
+			exitCode = WEXITSTATUS(status);
+		}
+		pid = -1;
+	}
+	return exitCode;
+}
+
+bool PosixProcessPipe::IsRunning() {
+	pid_t running = pid;
+	if (running <= 0) {
+		return false;
+	}
+	// WNOWAIT leaves the exit status to Stop(), which can run on another thread
+	siginfo_t info;
+	info.si_pid = 0;
+	if (waitid(P_PID, running, &info, WEXITED | WNOHANG | WNOWAIT) != 0) {
+		return false;
+	}
+	return info.si_pid == 0;
+}
+
+int PosixProcessPipe::Read(char *buffer, size_t size) {
+	if (stdOutRd < 0) {
+		return -1;
+	}
+	ssize_t count = read(stdOutRd, buffer, size);
+	if (count < 0) {
+		return errno == EINTR || errno == EAGAIN ? 0 : -1;
+	}
+	// 0 is the end of the stream: the service exited
+	return count == 0 ? -1 : (int)count;
+}
+
+bool PosixProcessPipe::Write(const char *data, size_t size) {
+	while (size > 0) {
+		if (stdInWr < 0) {
+			return false;
+		}
+		ssize_t count = write(stdInWr, data, size);
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		data += count;
+		size -= count;
+	}
+	return true;
+}
+
+void FutexRingSignal::Wake(std::atomic<uint32_t> &sequence) {
+	syscall(SYS_futex, (uint32_t *)&sequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+void FutexRingSignal::Wait(std::atomic<uint32_t> &sequence, uint32_t expected, uint32_t timeout) {
+	struct timespec relative;
+	relative.tv_sec = timeout / 1000;
+	relative.tv_nsec = (long)(timeout % 1000) * 1000000;
+	// Returns at once with EAGAIN if the sequence already changed
+	syscall(SYS_futex, (uint32_t *)&sequence, FUTEX_WAIT, expected, &relative, NULL, 0);
+}
+
+PosixSharedMemoryPipe::~PosixSharedMemoryPipe() {
+	Close();
+	if (region) {
+		munmap(region, size);
+	}
+	if (created) {
+		shm_unlink(name.c_str());
+	}
+}
+
+bool PosixSharedMemoryPipe::Map(int fd, size_t size) {
+	void *mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+	region = mapped;
+	this->size = size;
+	return true;
+}
+
+bool PosixSharedMemoryPipe::Create(const std::string &name, uint32_t capacity) {
+	size_t regionSize = RegionSize(capacity);
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0) {
+		return false;
+	}
+	this->name = name;
+	created = true;
+	if (ftruncate(fd, (off_t)regionSize) != 0) {
+		close(fd);
+		return false;
+	}
+	if (!Map(fd, regionSize)) {
+		return false;
+	}
+
+	IRingSignal *signals[kSignal_Count] = { &signal, &signal, &signal, &signal };
+	InitializeRegion(region, capacity, (uint32_t)getpid());
+	return Attach(region, size, signals);
+}
+
+bool PosixSharedMemoryPipe::Open(const std::string &name) {
+	int fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SharedTransportHeader)) {
+		close(fd);
+		return false;
+	}
+	if (!Map(fd, (size_t)info.st_size)) {
+		return false;
+	}
+
+	IRingSignal *signals[kSignal_Count] = { &signal, &signal, &signal, &signal };
+	return Attach(region, size, signals);
+}
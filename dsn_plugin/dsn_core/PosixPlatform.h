@@ -0,0 +1,65 @@
+#pragma once
+#include "Platform.h"
+#include "SharedMemoryPipe.h"
+#include <atomic>
+#include <string>
+#include <sys/types.h>
+
+// POSIX implementations of the platform interfaces, to drive the client against a stand-in
+// speech recognition service on Linux (not compiled on Windows)
+
+// Runs `commandLine` with /bin/sh and connects to its stdin/stdout
+class PosixProcessPipe : public IPipe
+{
+public:
+	PosixProcessPipe() {}
+	~PosixProcessPipe();
+
+	bool Start(const std::string &commandLine);
+	// Close the stdin of the process and wait for it to exit. Returns the exit code, or -1.
+	// Output written by the process before it exited can still be read.
+	int Stop();
+	// Returns false once the process exited, can be called from any thread
+	bool IsRunning();
+
+	int Read(char *buffer, size_t size) override;
+	bool Write(const char *data, size_t size) override;
+
+private:
+	std::atomic<pid_t> pid{ -1 };
+	int exitCode = -1;
+	int stdInWr = -1;
+	int stdOutRd = -1;
+};
+
+// Futex on the sequence word, which works across processes in a shared mapping
+class FutexRingSignal : public IRingSignal
+{
+public:
+	void Wake(std::atomic<uint32_t> &sequence) override;
+	void Wait(std::atomic<uint32_t> &sequence, uint32_t expected, uint32_t timeout) override;
+};
+
+// SharedMemoryPipe on a POSIX shared memory object (shm_open), named like "/dsn_<pid>"
+class PosixSharedMemoryPipe : public SharedMemoryPipe
+{
+public:
+	explicit PosixSharedMemoryPipe(Side side) : SharedMemoryPipe(side) {}
+	~PosixSharedMemoryPipe();
+
+	// Plugin side: create the region, it is removed when the pipe is deleted
+	bool Create(const std::string &name, uint32_t capacity = kDefaultCapacity);
+	// Service side: map the region created by the plugin
+	bool Open(const std::string &name);
+	// Service side: the process id of the plugin, written in the region
+	uint32_t GetPluginProcessId() const { return header ? header->pluginProcessId : 0; }
+
+private:
+	bool Map(int fd, size_t size);
+
+	std::string name;
+	bool created = false;
+	void *region = nullptr;
+	size_t size = 0;
+	FutexRingSignal signal;
+};
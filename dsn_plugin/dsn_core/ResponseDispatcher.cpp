@@ -0,0 +1,301 @@
+#include "ResponseDispatcher.h"
+#include "SpeechProtocol.h"
+#include "Log.h"
+
+ResponseDispatcher::ResponseDispatcher(IClock &clock, CustomCommandHandler tryRunCustomCommand)
+	: clock(clock), tryRunCustomCommand(tryRunCustomCommand), debouncer(clock) {
+	launchedAt = clock.NowMilliseconds();
+}
+
+ResponseDispatcher::~ResponseDispatcher() {
+	{
+		std::lock_guard<std::mutex> lock(commandLaneLock);
+		stopping = true;
+		commandLaneChanged.notify_all();
+	}
+	if (commandLaneThread.joinable()) {
+		commandLaneThread.join();
+	}
+}
+
+void ResponseDispatcher::Dispatch(std::string_view line) {
+	if (debouncer.IsRepeat(line)) {
+		return;
+	}
+
+	Response response;
+	if (!ParseResponse(line, response)) {
+		return;
+	}
+
+	switch (response.type) {
+	case kResponse_Dialogue:
+		if (response.dialogueId == currentDialogueId) {
+			selectedAt = clock.NowMilliseconds();
+			selectedIndex = response.index;
+		}
+		break;
+	case kResponse_Command: {
+		uint64_t expiresAt = ExpiresAt(response);
+		uint32_t id = ++lastResponse;
+		splitCommands.clear();
+		SplitCommands(response.payload, splitCommands);
+		for (std::string_view command : splitCommands)
+			QueueOnCommandLane(nullptr, std::string(command), expiresAt, id);
+		break;
+	}
+	case kResponse_CommandId: {
+		const std::vector<ParsedCommandPtr> *commands = commandTable.Find(response.commandId);
+		if (!commands) {
+			unknownCommandIds.fetch_add(1, std::memory_order_relaxed);
+			Log::info("Ignored command id " + std::to_string(response.commandId) + ", it is not registered");
+			break;
+		}
+		uint64_t expiresAt = ExpiresAt(response);
+		uint32_t id = ++lastResponse;
+		for (const ParsedCommandPtr &command : *commands)
+			QueueOnCommandLane(command, std::string(), expiresAt, id);
+		break;
+	}
+	case kResponse_RegisterCommands:
+		Log::info("Registered " + std::to_string(commandTable.Register(response.payload)) + " commands of the speech service");
+		break;
+	case kResponse_Equip:
+		EnqueueEquip(response.payload);
+		break;
+	case kResponse_Phrase: {
+		QueuedPhrase queued = { (uint32_t)response.commandId, clock.NowMilliseconds() };
+		std::lock_guard<std::mutex> lock(queueLock);
+		queuedPhrases.push_back(queued);
+		break;
+	}
+	case kResponse_PapyrusEvent:
+		phraseEvents.Push(response.commandId, response.confidence, response.payload, clock.NowMilliseconds());
+		break;
+	case kResponse_Ready:
+		Log::info("Speech service stage '" + std::string(response.payload) + "' ready after " + std::to_string(response.elapsed)
+			+ " ms (" + std::to_string(clock.NowMilliseconds() - launchedAt) + " ms since the plugin launched it)");
+		break;
+	default:
+		break;
+	}
+}
+
+// The deadline counts from the recognition, `age` before the line was written by the service
+uint64_t ResponseDispatcher::ExpiresAt(const Response &response) {
+	if (response.deadline <= 0) {
+		return 0;
+	}
+	uint64_t now = clock.NowMilliseconds();
+	return (now > (uint64_t)response.age ? now - response.age : 0) + response.deadline;
+}
+
+void ResponseDispatcher::EnqueueCommand(std::string command, uint64_t expiresAt) {
+	QueueOnCommandLane(nullptr, std::move(command), expiresAt, ++lastResponse);
+}
+
+void ResponseDispatcher::QueueOnCommandLane(ParsedCommandPtr command, std::string text, uint64_t expiresAt, uint32_t response) {
+	QueuedCommand queued = { std::move(command), std::move(text), clock.NowMilliseconds(), expiresAt, response, false };
+	std::lock_guard<std::mutex> lock(commandLaneLock);
+	commandLane.push_back(std::move(queued));
+	commandLaneChanged.notify_all();
+
+	if (!commandLaneThread.joinable()) {
+		commandLaneThread = std::thread(&ResponseDispatcher::RunCommandLane, this);
+	}
+}
+
+void ResponseDispatcher::RunCommandLane() {
+	uint32_t startedResponse = 0;  // the last response that ran a custom command
+	std::unique_lock<std::mutex> lock(commandLaneLock);
+	for (;;) {
+		commandLaneChanged.wait(lock, [this] { return stopping || !commandLane.empty(); });
+		if (stopping) {
+			return;
+		}
+
+		QueuedCommand queued = std::move(commandLane.front());
+		commandLane.pop_front();
+		runningCommand = true;
+		lock.unlock();
+
+		if (!queued.command) {
+			queued.command = std::make_shared<const ParsedCommand>(CustomCommandRunner::Parse(std::move(queued.text)));
+		}
+
+		// The custom command will be executed on the current thread,
+		// and the Skyrim command will be executed in the game thread.
+		bool runHere = tryRunCustomCommand && queued.command->IsCustom();
+		{
+			// A response has started once any of its commands ran, here or on the game thread
+			std::lock_guard<std::mutex> queueGuard(queueLock);
+			queued.started = queued.response == startedResponse || queued.response == gameStartedResponse;
+			uint64_t now = clock.NowMilliseconds();
+			if (!queued.started && IsExpired(queued, now)) {
+				DropExpired(queued, now);
+				runHere = false;
+			}
+			else if (runHere) {
+				// Its console commands waiting for the game thread must not expire anymore
+				startedResponse = queued.response;
+				for (QueuedCommand &pending : queuedCommands) {
+					if (pending.response == queued.response) {
+						pending.started = true;
+					}
+				}
+			}
+			else {
+				queuedCommands.push_back(std::move(queued));
+			}
+		}
+
+		if (runHere) {
+			if (tryRunCustomCommand(*queued.command)) {
+				RecordLaneDelay(kLane_Command, queued.queuedAt);
+			}
+			else {
+				queued.started = true;
+				std::lock_guard<std::mutex> queueGuard(queueLock);
+				queuedCommands.push_back(std::move(queued));
+			}
+		}
+
+		lock.lock();
+		runningCommand = false;
+		commandLaneChanged.notify_all();
+	}
+}
+
+void ResponseDispatcher::FlushCommands() {
+	std::unique_lock<std::mutex> lock(commandLaneLock);
+	commandLaneChanged.wait(lock, [this] { return stopping || (commandLane.empty() && !runningCommand); });
+}
+
+void ResponseDispatcher::EnqueueEquip(std::string_view equip) {
+	EquipItem item;
+	EquipParseResult result = ParseEquipItem(equip, item);
+	if (result != kEquipParse_Ok) {
+		Log::info(std::string("Ignored malformed equip command (") + EquipParseResultToString(result) + "): " + std::string(equip));
+		return;
+	}
+
+	QueuedEquip queued = { item, clock.NowMilliseconds() };
+	std::lock_guard<std::mutex> lock(queueLock);
+	queuedEquips.push_back(queued);
+}
+
+void ResponseDispatcher::ServiceLaunched() {
+	launchedAt = clock.NowMilliseconds();
+}
+
+int ResponseDispatcher::StartDialogue() {
+	selectedIndex = -1;
+	return ++currentDialogueId;
+}
+
+int ResponseDispatcher::ReadSelectedIndex(uint64_t *selectedAt) {
+	int t = selectedIndex;
+	selectedIndex = -1;
+	if (t >= 0) {
+		RecordLaneDelay(kLane_Dialogue, this->selectedAt);
+	}
+	if (selectedAt) {
+		*selectedAt = this->selectedAt;
+	}
+	return t;
+}
+
+std::string ResponseDispatcher::PopCommand(uint64_t *queuedAt) {
+	// The reader thread pushes to the queues, they are only read with queueLock held
+	std::lock_guard<std::mutex> lock(queueLock);
+	if (queuedCommands.empty()) {
+		return "";
+	}
+
+	uint64_t now = clock.NowMilliseconds();
+	while (!queuedCommands.empty()) {
+		QueuedCommand queued = std::move(queuedCommands.front());
+		queuedCommands.pop_front();
+		if (!queued.started && queued.response != gameStartedResponse && IsExpired(queued, now)) {
+			DropExpired(queued, now);
+			continue;
+		}
+		gameStartedResponse = queued.response;
+
+		if (queuedAt) {
+			*queuedAt = queued.queuedAt;
+		}
+		RecordLaneDelay(kLane_Command, queued.queuedAt);
+		return queued.command->text;
+	}
+	return "";
+}
+
+bool ResponseDispatcher::IsExpired(const QueuedCommand &queued, uint64_t now) {
+	return queued.expiresAt != 0 && now > queued.expiresAt;
+}
+
+void ResponseDispatcher::DropExpired(const QueuedCommand &queued, uint64_t now) {
+	Log::info("Dropped command '" + queued.command->text + "', " + std::to_string(now - queued.expiresAt) + " ms past its deadline");
+
+	std::lock_guard<std::mutex> lock(statsLock);
+	laneStats[kLane_Command].expired++;
+}
+
+void ResponseDispatcher::PopEquips(std::vector<EquipItem> &equips) {
+	std::lock_guard<std::mutex> lock(queueLock);
+	for (const QueuedEquip &queued : queuedEquips) {
+		equips.push_back(queued.item);
+		RecordLaneDelay(kLane_Equip, queued.queuedAt);
+	}
+	queuedEquips.clear();
+}
+
+void ResponseDispatcher::PopPhrases(std::vector<uint32_t> &phrases) {
+	std::lock_guard<std::mutex> lock(queueLock);
+	for (const QueuedPhrase &queued : queuedPhrases) {
+		phrases.push_back(queued.id);
+		RecordLaneDelay(kLane_Command, queued.queuedAt);
+	}
+	queuedPhrases.clear();
+}
+
+void ResponseDispatcher::PopPhraseEvents(std::vector<PhraseEvent> &batch) {
+	if (phraseEvents.TakeBatch(batch) == 0) {
+		return;
+	}
+	for (const PhraseEvent &event : batch) {
+		RecordLaneDelay(kLane_Command, event.queuedAt);
+	}
+}
+
+void ResponseDispatcher::RecordLaneDelay(ResponseLane lane, uint64_t queuedAt) {
+	uint64_t now = clock.NowMilliseconds();
+	uint64_t delay = now > queuedAt ? now - queuedAt : 0;
+
+	std::lock_guard<std::mutex> lock(statsLock);
+	LaneStats &stats = laneStats[lane];
+	stats.count++;
+	stats.totalDelay += delay;
+	if (delay > stats.maxDelay) {
+		stats.maxDelay = delay;
+	}
+}
+
+LaneStats ResponseDispatcher::GetLaneStats(ResponseLane lane) {
+	std::lock_guard<std::mutex> lock(statsLock);
+	return laneStats[lane];
+}
+
+const char *ResponseDispatcher::LaneName(ResponseLane lane) {
+	switch (lane) {
+	case kLane_Dialogue:
+		return "dialogue";
+	case kLane_Equip:
+		return "equip";
+	case kLane_Command:
+		return "command";
+	default:
+		return "unknown";
+	}
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include "CommandDebouncer.h"
+#include "CommandTable.h"
+#include "CustomCommands.h"
+#include "EquipParser.h"
+#include "PhraseEventQueue.h"
+#include "Platform.h"
+#include "SpeechProtocol.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Lanes of the responses of the service, by priority. A dialogue topic selection never waits behind an equip
+// or a command macro: Dispatch() only stores it, while commands are handed to the command lane's thread.
+enum ResponseLane
+{
+	kLane_Dialogue = 0,
+	kLane_Equip,
+	kLane_Command,
+
+	kLane_Count
+};
+
+// Queueing delay of a lane: from the receipt of a response until it is handled
+// (taken by the game thread, or run for custom commands), in milliseconds
+struct LaneStats {
+	uint64_t count;
+	uint64_t totalDelay;
+	uint64_t maxDelay;
+	uint64_t expired;  // commands dropped because they were past their deadline
+};
+
+// Dispatch of the messages received from the speech recognition service (see SpeechProtocol.h).
+//
+// Dispatch() is called on the thread reading the service's output, the Pop/Read methods on the game thread.
+// Commands are run in order on the command lane's thread: custom commands (see CustomCommands.h) directly,
+// Skyrim console commands are queued for the game thread like the equips. COMMAND_ID responses are looked up
+// in the table registered by the service (see CommandTable.h). The recognized phrases of other plugins
+// (see PhraseRegistry.h) and the Papyrus events of tagged phrases (see PhraseEventQueue.h) are queued for the
+// game thread too, on the command lane.
+//
+// Commands with a deadline (see COMMAND in SpeechProtocol.h) are dropped once it has passed, on the command lane
+// or by the game thread for console commands. Only the commands of a response that has not started yet are
+// dropped: once one of its commands ran on either thread, the rest run too, so a macro is never cut in the
+// middle (e.g. between holdkey and releasekey).
+class ResponseDispatcher
+{
+public:
+	// Returns true if the command was run as a custom command
+	typedef std::function<bool(const ParsedCommand &command)> CustomCommandHandler;
+
+	// `clock` timestamps the queued commands, to measure how long they wait for the game thread,
+	// and the startup stages of the service, relative to its launch
+	ResponseDispatcher(IClock &clock, CustomCommandHandler tryRunCustomCommand);
+	~ResponseDispatcher();
+
+	// Handle one line received from the service
+	void Dispatch(std::string_view line);
+
+	// Queue a command on the command lane, its thread is started with the first command.
+	// It is dropped if it has not run at `expiresAt` (0: never).
+	void EnqueueCommand(std::string command, uint64_t expiresAt = 0);
+	void EnqueueEquip(std::string_view equip);
+	// Wait until the command lane has run or queued every command
+	void FlushCommands();
+
+	// Called when the service is (re)launched, resets the time the startup stages are reported against
+	void ServiceLaunched();
+
+	// Start a new dialogue, responses to older dialogues are ignored. Returns the id of the dialogue.
+	int StartDialogue();
+	// Returns the topic index selected by voice, or -1. `selectedAt` receives when it was received.
+	int ReadSelectedIndex(uint64_t *selectedAt = nullptr);
+	// Returns the oldest queued console command, or "" if there are none.
+	// `queuedAt` receives when the command was queued.
+	std::string PopCommand(uint64_t *queuedAt = nullptr);
+	// Move all pending equip commands to the end of `equips`
+	void PopEquips(std::vector<EquipItem> &equips);
+	// Move the ids of the registered phrases recognized since the last call to the end of `phrases`
+	void PopPhrases(std::vector<uint32_t> &phrases);
+	// Move the Papyrus events of the tagged phrases to `batch` (cleared first), once per frame
+	void PopPhraseEvents(std::vector<PhraseEvent> &batch);
+	uint64_t GetDroppedPhraseEvents() { return phraseEvents.Dropped(); }
+
+	// Repeated COMMAND lines are dropped before they are parsed, see CommandDebouncer
+	void SetRepeatWindow(uint32_t milliseconds) { debouncer.SetWindow(milliseconds); }
+	uint64_t GetSuppressedRepeats() const { return debouncer.Suppressed(); }
+	// Ids of COMMAND_ID responses that were not registered
+	uint64_t GetUnknownCommandIds() const { return unknownCommandIds.load(std::memory_order_relaxed); }
+
+	LaneStats GetLaneStats(ResponseLane lane);
+	static const char *LaneName(ResponseLane lane);
+
+private:
+	struct QueuedCommand {
+		ParsedCommandPtr command;  // parsed on the command lane for the commands not registered in the table
+		std::string text;
+		uint64_t queuedAt;
+		uint64_t expiresAt;
+		uint32_t response;  // the commands of a COMMAND line share it
+		bool started;       // a command of the response already ran, it does not expire
+	};
+
+	struct QueuedEquip {
+		EquipItem item;
+		uint64_t queuedAt;
+	};
+
+	struct QueuedPhrase {
+		uint32_t id;
+		uint64_t queuedAt;
+	};
+
+	uint64_t ExpiresAt(const Response &response);
+	void QueueOnCommandLane(ParsedCommandPtr command, std::string text, uint64_t expiresAt, uint32_t response);
+	void RunCommandLane();
+	void RecordLaneDelay(ResponseLane lane, uint64_t queuedAt);
+	bool IsExpired(const QueuedCommand &queued, uint64_t now);
+	void DropExpired(const QueuedCommand &queued, uint64_t now);
+
+	IClock &clock;
+	CustomCommandHandler tryRunCustomCommand;
+	CommandDebouncer debouncer;
+	CommandTable commandTable;
+	std::atomic<uint64_t> unknownCommandIds{ 0 };
+
+	int selectedIndex = -1;
+	uint64_t selectedAt = 0;
+	int currentDialogueId = 0;
+	uint64_t launchedAt;
+
+	std::mutex queueLock;
+	std::deque<QueuedCommand> queuedCommands;
+	uint32_t gameStartedResponse = 0;  // the response of the last console command taken by the game thread
+	std::vector<QueuedEquip> queuedEquips;
+	std::vector<QueuedPhrase> queuedPhrases;
+	PhraseEventQueue phraseEvents;
+	std::vector<std::string_view> splitCommands;
+
+	std::mutex commandLaneLock;
+	std::condition_variable commandLaneChanged;
+	std::deque<QueuedCommand> commandLane;
+	std::atomic<uint32_t> lastResponse{ 0 };
+	bool runningCommand = false;
+	bool stopping = false;
+	std::thread commandLaneThread;
+
+	std::mutex statsLock;
+	LaneStats laneStats[kLane_Count] = {};
+};
@@ -0,0 +1,91 @@
+#include "ServiceSupervision.h"
+#include <algorithm>
+#include <charconv>
+
+// Consume the next '|' separated field of `rest`
+static std::string_view nextField(std::string_view &rest) {
+	size_t sep = rest.find('|');
+	std::string_view field = rest.substr(0, sep);
+	rest = sep == std::string_view::npos ? std::string_view() : rest.substr(sep + 1);
+	return field;
+}
+
+static bool parseId(std::string_view field, uint32_t &id) {
+	std::from_chars_result res = std::from_chars(field.data(), field.data() + field.size(), id);
+	return res.ec == std::errc() && res.ptr != field.data();
+}
+
+const uint32_t RestartBackoff::kInitialDelay;
+const uint32_t RestartBackoff::kMaxDelay;
+const uint32_t RestartBackoff::kStableRunTime;
+
+uint32_t RestartBackoff::NextDelay(uint64_t ranFor) {
+	if (ranFor >= kStableRunTime) {
+		delay = 0;
+		attempts = 0;
+	}
+
+	attempts++;
+	delay = delay == 0 ? kInitialDelay : std::min(delay * 2, kMaxDelay);
+	return delay;
+}
+
+void ServiceState::Remember(std::string_view line) {
+	std::string_view rest = line;
+	std::string_view message = nextField(rest);
+	uint32_t id;
+
+	if (message == "REGISTER_PHRASES") {
+		while (!rest.empty()) {
+			std::string_view idField = nextField(rest);
+			std::string_view phrase = nextField(rest);
+			if (parseId(idField, id)) {
+				registeredPhrases[id].assign(phrase);
+			}
+		}
+	}
+	else if (message == "UNREGISTER_PHRASES") {
+		while (!rest.empty()) {
+			if (parseId(nextField(rest), id)) {
+				registeredPhrases.erase(id);
+			}
+		}
+	}
+	else if (message == "FAVORITES") {
+		currentFavorites.assign(line);
+	}
+	else if (message == "START_DIALOGUE") {
+		currentDialogue.assign(line);
+	}
+	else if (message == "STOP_DIALOGUE") {
+		currentDialogue.clear();
+	}
+	else if (message == "LISTEN_PAUSE") {
+		listenPause.assign(line);
+	}
+	else if (message == "LISTEN_RESUME") {
+		listenPause.clear();
+	}
+}
+
+void ServiceState::GetRestoreLines(std::vector<std::string> &lines) const {
+	// The phrases are part of the command mode grammars, sent first like the service's own commands
+	if (!registeredPhrases.empty()) {
+		std::string phrases = "REGISTER_PHRASES";
+		for (const auto &entry : registeredPhrases) {
+			phrases.append("|").append(std::to_string(entry.first)).append("|").append(entry.second);
+		}
+		lines.push_back(phrases);
+	}
+	// Favorites before the dialogue, the service only switches to command mode with them when no dialogue is active
+	if (!currentFavorites.empty()) {
+		lines.push_back(currentFavorites);
+	}
+	if (!currentDialogue.empty()) {
+		lines.push_back(currentDialogue);
+	}
+	// Last, the service keeps the grammars of the other lines loaded while paused
+	if (!listenPause.empty()) {
+		lines.push_back(listenPause);
+	}
+}
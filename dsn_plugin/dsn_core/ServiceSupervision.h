@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Supervision of the speech recognition service: when it exits or closes its stdout, the plugin launches it
+// again and sends it the state it lost, like the service does itself after reloading its configuration file
+// (ConsoleInput.RestoreSavedState in dsn_service).
+
+// Delay before launching the service again. It starts at kInitialDelay and doubles, up to kMaxDelay,
+// for every launch that ran less than kStableRunTime.
+class RestartBackoff
+{
+public:
+	static const uint32_t kInitialDelay = 250;
+	static const uint32_t kMaxDelay = 30000;
+	static const uint32_t kStableRunTime = 60000;
+
+	// Returns the delay before the next launch, `ranFor` is how long the last launch ran (0 if it failed)
+	uint32_t NextDelay(uint64_t ranFor);
+	// Number of consecutive restarts since the service last ran for kStableRunTime
+	uint32_t Attempts() const { return attempts; }
+
+private:
+	uint32_t delay = 0;
+	uint32_t attempts = 0;
+};
+
+// The state of the service that a restart loses: the phrases registered by other plugins, the favorites,
+// the current dialogue and a paused recognition.
+// Not thread-safe, the caller serializes it with the writes to the service.
+class ServiceState
+{
+public:
+	// Remember a line sent to the service
+	void Remember(std::string_view line);
+	// Append the lines restoring the state to `lines`, in the order the service expects them
+	void GetRestoreLines(std::vector<std::string> &lines) const;
+
+private:
+	std::map<uint32_t, std::string> registeredPhrases;
+	std::string currentFavorites;
+	std::string currentDialogue;
+	std::string listenPause;
+};
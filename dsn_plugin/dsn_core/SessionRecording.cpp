@@ -0,0 +1,68 @@
+#include "SessionRecording.h"
+#include <charconv>
+#include <fstream>
+
+static const char *SESSION_HEADER = "DSN_SESSION 1";
+
+SessionRecorder::SessionRecorder(IClock &clock) : clock(clock) {
+}
+
+SessionRecorder::~SessionRecorder() {
+	if (file) {
+		fclose(file);
+	}
+}
+
+bool SessionRecorder::Open(const std::string &path) {
+	std::lock_guard<std::mutex> lock(fileLock);
+	if (file) {
+		fclose(file);
+	}
+
+	file = fopen(path.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+	startTime = clock.NowMilliseconds();
+	fprintf(file, "%s\n", SESSION_HEADER);
+	fflush(file);
+	return true;
+}
+
+void SessionRecorder::Record(char direction, std::string_view line) {
+	uint64_t time = clock.NowMilliseconds() - startTime;
+
+	std::lock_guard<std::mutex> lock(fileLock);
+	if (!file) {
+		return;
+	}
+	fprintf(file, "%llu %c ", (unsigned long long)time, direction);
+	fwrite(line.data(), 1, line.size(), file);
+	fputc('\n', file);
+	fflush(file);
+}
+
+bool ReadSessionRecording(const std::string &path, std::vector<SessionLine> &lines) {
+	std::ifstream file(path, std::ios_base::in | std::ios_base::binary);
+	std::string line;
+	if (!std::getline(file, line) || line != SESSION_HEADER) {
+		return false;
+	}
+
+	while (std::getline(file, line)) {
+		// <time> <direction> <line>
+		SessionLine entry;
+		const char *end = line.data() + line.size();
+		std::from_chars_result res = std::from_chars(line.data(), end, entry.time);
+		if (res.ec != std::errc() || end - res.ptr < 3 || res.ptr[0] != ' ' || res.ptr[2] != ' ') {
+			continue;
+		}
+		entry.direction = res.ptr[1];
+		if (entry.direction != kSessionLine_Inbound && entry.direction != kSessionLine_Outbound) {
+			continue;
+		}
+		entry.line.assign(res.ptr + 3, end);
+		lines.push_back(std::move(entry));
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Platform.h"
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Recording of the lines exchanged with the speech recognition service, to replay play sessions
+// with dsn_replay (see replay/ReplayMain.cpp).
+//
+// File format, one line per protocol line:
+//
+//   DSN_SESSION 1
+//   <milliseconds since the recording started> <'<' received from the service | '>' sent to the service> <line>
+
+static const char kSessionLine_Inbound = '<';
+static const char kSessionLine_Outbound = '>';
+
+struct SessionLine {
+	uint64_t time;
+	char direction;
+	std::string line;
+};
+
+// Thread-safe, lines are written (and flushed) as they are recorded
+class SessionRecorder
+{
+public:
+	explicit SessionRecorder(IClock &clock);
+	~SessionRecorder();
+
+	bool Open(const std::string &path);
+	void Record(char direction, std::string_view line);
+
+private:
+	IClock &clock;
+	uint64_t startTime = 0;
+	FILE *file = nullptr;
+	std::mutex fileLock;
+};
+
+// Returns false if the file cannot be read or is not a session recording
+bool ReadSessionRecording(const std::string &path, std::vector<SessionLine> &lines);
@@ -0,0 +1,199 @@
+#include "SharedMemoryPipe.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <thread>
+
+// The layout is shared with dsn_service (SharedMemoryTransport.cs)
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+	"the rings need lock-free atomics, they are shared between processes");
+static_assert(offsetof(SharedTransportHeader, rings) == 64, "layout of the shared memory region changed");
+static_assert(offsetof(SharedRingControl, tail) == 64 && offsetof(SharedRingControl, dataSequence) == 128 &&
+	offsetof(SharedRingControl, spaceSequence) == 192, "layout of the shared memory region changed");
+static_assert(sizeof(SharedTransportHeader) == 576, "layout of the shared memory region changed");
+
+size_t SharedMemoryPipe::RegionSize(uint32_t capacity) {
+	return sizeof(SharedTransportHeader) + (size_t)capacity * kRing_Count;
+}
+
+void SharedMemoryPipe::InitializeRegion(void *region, uint32_t capacity, uint32_t pluginProcessId) {
+	// A new region is zero-filled: the rings are empty, no side attached or closed
+	SharedTransportHeader *newHeader = new (region) SharedTransportHeader();
+	newHeader->magic = kSharedTransportMagic;
+	newHeader->version = kSharedTransportVersion;
+	newHeader->capacity = capacity;
+	newHeader->pluginProcessId = pluginProcessId;
+}
+
+bool SharedMemoryPipe::Attach(void *region, size_t size, IRingSignal *signals[kSignal_Count]) {
+	SharedTransportHeader *mapped = (SharedTransportHeader *)region;
+	if (size < sizeof(SharedTransportHeader) || mapped->magic != kSharedTransportMagic ||
+		mapped->version != kSharedTransportVersion || mapped->capacity == 0 ||
+		(mapped->capacity & (mapped->capacity - 1)) != 0 || size < RegionSize(mapped->capacity)) {
+		return false;
+	}
+
+	if (side == kSide_Service) {
+		uint32_t waiting = kAttach_Waiting;
+		if (!mapped->attachState.compare_exchange_strong(waiting, kAttach_Service)) {
+			return false;
+		}
+	}
+
+	header = mapped;
+	mask = header->capacity - 1;
+	char *data = (char *)region + sizeof(SharedTransportHeader);
+	SharedRing inRing = side == kSide_Plugin ? kRing_ToPlugin : kRing_ToService;
+	SharedRing outRing = side == kSide_Plugin ? kRing_ToService : kRing_ToPlugin;
+	in = &header->rings[inRing];
+	out = &header->rings[outRing];
+	inData = data + (size_t)header->capacity * inRing;
+	outData = data + (size_t)header->capacity * outRing;
+
+	if (side == kSide_Plugin) {
+		inDataSignal = signals[kSignal_ToPluginData];
+		inSpaceSignal = signals[kSignal_ToPluginSpace];
+		outDataSignal = signals[kSignal_ToServiceData];
+		outSpaceSignal = signals[kSignal_ToServiceSpace];
+	}
+	else {
+		inDataSignal = signals[kSignal_ToServiceData];
+		inSpaceSignal = signals[kSignal_ToServiceSpace];
+		outDataSignal = signals[kSignal_ToPluginData];
+		outSpaceSignal = signals[kSignal_ToPluginSpace];
+	}
+	return true;
+}
+
+int SharedMemoryPipe::Read(char *buffer, size_t size) {
+	if (!header) {
+		return -1;
+	}
+
+	// The other process is only checked when a wait ended without data
+	bool checkPeer = false;
+	uint32_t spins = 0;
+	for (;;) {
+		uint64_t tail = in->tail.load(std::memory_order_relaxed);
+		uint64_t head = in->head.load(std::memory_order_acquire);
+		if (head != tail) {
+			size_t count = (size_t)std::min<uint64_t>(size, head - tail);
+			size_t offset = (size_t)(tail & mask);
+			size_t first = std::min<size_t>(count, mask + 1 - offset);
+			memcpy(buffer, inData + offset, first);
+			memcpy(buffer + first, inData, count - first);
+			in->tail.store(tail + count, std::memory_order_release);
+
+			in->spaceSequence.fetch_add(1);
+			if (in->writerWaiting.load()) {
+				inSpaceSignal->Wake(in->spaceSequence);
+			}
+			return (int)count;
+		}
+
+		// The data written before the other side closed is read first
+		if ((IsPeerClosed() || (checkPeer && IsPeerGone())) && in->head.load(std::memory_order_acquire) == tail) {
+			return -1;
+		}
+
+		// Data often follows shortly (the lines of a burst): yield a few times before sleeping,
+		// which spares the writer a wakeup
+		if (spins < kSpinCount) {
+			spins++;
+			std::this_thread::yield();
+			continue;
+		}
+		spins = 0;
+
+		in->readerWaiting.store(1);
+		uint32_t sequence = in->dataSequence.load();
+		if (in->head.load() == tail && !IsPeerClosed()) {
+			inDataSignal->Wait(in->dataSequence, sequence, kWaitSlice);
+		}
+		in->readerWaiting.store(0);
+		checkPeer = true;
+	}
+}
+
+bool SharedMemoryPipe::Write(const char *data, size_t size) {
+	if (!header) {
+		return false;
+	}
+
+	while (size > 0) {
+		if (closed) {
+			return false;
+		}
+
+		uint64_t head = out->head.load(std::memory_order_relaxed);
+		uint64_t tail = out->tail.load(std::memory_order_acquire);
+		size_t space = (size_t)(mask + 1 - (head - tail));
+		if (space == 0) {
+			if (IsPeerGone()) {
+				return false;
+			}
+			out->writerWaiting.store(1);
+			uint32_t sequence = out->spaceSequence.load();
+			if (out->tail.load() == tail) {
+				outSpaceSignal->Wait(out->spaceSequence, sequence, kWaitSlice);
+			}
+			out->writerWaiting.store(0);
+			continue;
+		}
+
+		size_t count = std::min(space, size);
+		size_t offset = (size_t)(head & mask);
+		size_t first = std::min<size_t>(count, mask + 1 - offset);
+		memcpy(outData + offset, data, first);
+		memcpy(outData, data + first, count - first);
+		out->head.store(head + count, std::memory_order_release);
+
+		out->dataSequence.fetch_add(1);
+		if (out->readerWaiting.load()) {
+			outDataSignal->Wake(out->dataSequence);
+		}
+		data += count;
+		size -= count;
+	}
+	return true;
+}
+
+void SharedMemoryPipe::Close() {
+	if (!header || closed) {
+		return;
+	}
+	closed = true;
+
+	(side == kSide_Plugin ? header->pluginClosed : header->serviceClosed).store(1);
+	// Wake the other side if it waits for data, it reads the end of the stream
+	out->dataSequence.fetch_add(1);
+	outDataSignal->Wake(out->dataSequence);
+}
+
+bool SharedMemoryPipe::WaitForService(uint32_t timeout) {
+	const uint32_t kPollInterval = 10;
+
+	if (!header) {
+		return false;
+	}
+	for (uint32_t waited = 0; header->attachState.load() == kAttach_Waiting; waited += kPollInterval) {
+		if (waited >= timeout || IsPeerGone()) {
+			// Unless the service attached in the meantime
+			uint32_t waiting = kAttach_Waiting;
+			header->attachState.compare_exchange_strong(waiting, kAttach_Refused);
+			break;
+		}
+		// Nothing is written before the service attached, the data signal is only used to sleep
+		inDataSignal->Wait(in->dataSequence, in->dataSequence.load(), kPollInterval);
+	}
+	return header->attachState.load() == kAttach_Service;
+}
+
+bool SharedMemoryPipe::IsPeerClosed() const {
+	return (side == kSide_Plugin ? header->serviceClosed : header->pluginClosed).load() != 0;
+}
+
+bool SharedMemoryPipe::IsPeerGone() {
+	return isPeerAlive && !isPeerAlive();
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "Platform.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Optional transport between the plugin and the speech recognition service: a shared memory region with one
+// single-producer single-consumer byte ring per direction, instead of the anonymous pipes of stdin/stdout.
+// A message costs a copy into the ring and, only when the other side is asleep, a wakeup.
+//
+// The plugin creates the region and launches the service with "--shared-memory <name>".
+// The region is mapped by the platform implementations (WindowsSharedMemoryPipe, PosixSharedMemoryPipe),
+// dsn_service maps it in SharedMemoryTransport.cs. Layout (offsets in bytes, little endian):
+//
+//     0  SharedTransportHeader: magic, version, ring capacity, plugin process id, attach state, closed flags
+//    64  SharedRingControl of the plugin -> service ring
+//   320  SharedRingControl of the service -> plugin ring
+//   576  data of the plugin -> service ring (capacity bytes), then the data of the service -> plugin ring
+//
+// A reader sets readerWaiting, checks the ring again and sleeps on dataSequence. A writer publishes `head`,
+// increments dataSequence and wakes the reader only if readerWaiting is set. The same goes for a writer
+// waiting for space (writerWaiting, spaceSequence).
+//
+// The service attaches by changing attachState from kAttach_Waiting to kAttach_Service. A plugin that gave up
+// waiting changes it to kAttach_Refused instead, then both sides use stdin/stdout: whichever changes it first
+// decides, so they always agree on the transport.
+
+static const uint32_t kSharedTransportMagic = 0x524E5344; // "DSNR"
+static const uint32_t kSharedTransportVersion = 1;
+
+struct SharedRingControl {
+	alignas(64) std::atomic<uint64_t> head;  // bytes written since the creation, by the writer
+	alignas(64) std::atomic<uint64_t> tail;  // bytes read, by the reader
+	alignas(64) std::atomic<uint32_t> dataSequence;
+	std::atomic<uint32_t> readerWaiting;
+	alignas(64) std::atomic<uint32_t> spaceSequence;
+	std::atomic<uint32_t> writerWaiting;
+};
+
+enum SharedRing
+{
+	kRing_ToService = 0,
+	kRing_ToPlugin,
+
+	kRing_Count
+};
+
+enum SharedAttachState
+{
+	kAttach_Waiting = 0,
+	kAttach_Service,
+	kAttach_Refused
+};
+
+struct SharedTransportHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity;         // bytes of each ring, a power of two
+	uint32_t pluginProcessId;  // lets the service notice the game is gone
+	std::atomic<uint32_t> attachState;  // SharedAttachState
+	std::atomic<uint32_t> pluginClosed;
+	std::atomic<uint32_t> serviceClosed;
+	alignas(64) SharedRingControl rings[kRing_Count];
+};
+
+// Signals of the rings: the reader of a ring waits for data, its writer for space.
+// On Windows they are named events "<region name>.<index>".
+enum SharedRingSignal
+{
+	kSignal_ToServiceData = 0,
+	kSignal_ToServiceSpace,
+	kSignal_ToPluginData,
+	kSignal_ToPluginSpace,
+
+	kSignal_Count
+};
+
+class SharedMemoryPipe : public IPipe
+{
+public:
+	enum Side
+	{
+		kSide_Plugin = 0,
+		kSide_Service
+	};
+
+	static const uint32_t kDefaultCapacity = 64 * 1024;
+
+	static size_t RegionSize(uint32_t capacity);
+
+	// Read blocks until data is available, returns -1 once the other side closed the region and the ring is empty
+	int Read(char *buffer, size_t size) override;
+	// Blocks while the ring is full. Returns false once this side was closed, or if the other process is gone
+	// while the ring is full.
+	bool Write(const char *data, size_t size) override;
+
+	// Close the writing end of this side, like closing the stdin of the service: the other side reads
+	// the remaining data, then the end of the stream. This side can still read.
+	// Called by the platform implementations before they unmap the region.
+	void Close();
+	// Plugin side: wait until the service attached. Returns false if it did not within `timeout` milliseconds,
+	// the service can no longer attach then.
+	bool WaitForService(uint32_t timeout);
+	// Called while waiting, returns false once the other process is gone (it may not have closed the region)
+	void SetPeerCheck(std::function<bool()> isPeerAlive) { this->isPeerAlive = isPeerAlive; }
+
+protected:
+	explicit SharedMemoryPipe(Side side) : side(side) {}
+
+	// Plugin side: fill the header of a new region
+	static void InitializeRegion(void *region, uint32_t capacity, uint32_t pluginProcessId);
+	// Use a mapped region of `size` bytes. Returns false if it is not a region created by InitializeRegion(),
+	// or on the service side if the plugin no longer waits for it.
+	bool Attach(void *region, size_t size, IRingSignal *signals[kSignal_Count]);
+
+	SharedTransportHeader *header = nullptr;
+
+private:
+	// Waits are cut into slices to check the other process
+	static const uint32_t kWaitSlice = 100;
+	// Yields of a reader before it sleeps
+	static const uint32_t kSpinCount = 64;
+
+	bool IsPeerClosed() const;
+	bool IsPeerGone();
+
+	Side side;
+	SharedRingControl *in = nullptr;
+	SharedRingControl *out = nullptr;
+	char *inData = nullptr;
+	char *outData = nullptr;
+	uint32_t mask = 0;
+	IRingSignal *inDataSignal = nullptr;
+	IRingSignal *inSpaceSignal = nullptr;
+	IRingSignal *outDataSignal = nullptr;
+	IRingSignal *outSpaceSignal = nullptr;
+	std::function<bool()> isPeerAlive;
+	bool closed = false;
+};
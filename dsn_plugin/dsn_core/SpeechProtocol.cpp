@@ -0,0 +1,154 @@
+#include "SpeechProtocol.h"
+#include <charconv>
+
+// Consume the next `delim` separated field of `rest`
+static std::string_view nextField(std::string_view &rest, char delim) {
+	size_t sep = rest.find(delim);
+	std::string_view field = rest.substr(0, sep);
+	rest = sep == std::string_view::npos ? std::string_view() : rest.substr(sep + 1);
+	return field;
+}
+
+static bool parseInt(std::string_view field, int &out) {
+	std::from_chars_result res = std::from_chars(field.data(), field.data() + field.size(), out);
+	return res.ec == std::errc() && res.ptr != field.data();
+}
+
+static bool parseFloat(std::string_view field, float &out) {
+	const char *end = field.data() + field.size();
+	std::from_chars_result res = std::from_chars(field.data(), end, out);
+	return res.ec == std::errc() && res.ptr == end;
+}
+
+// The optional |<deadline>|<age> of the command messages, both are ignored if either is malformed
+static void parseDeadline(std::string_view rest, Response &response) {
+	if (!rest.empty() &&
+		(!parseInt(nextField(rest, '|'), response.deadline) || !parseInt(nextField(rest, '|'), response.age) ||
+		response.deadline < 0 || response.age < 0)) {
+		response.deadline = 0;
+		response.age = 0;
+	}
+}
+
+bool ParseResponse(std::string_view line, Response &response) {
+	response.type = kResponse_Unknown;
+	response.dialogueId = 0;
+	response.index = -1;
+	response.elapsed = 0;
+	response.commandId = -1;
+	response.confidence = 0;
+	response.deadline = 0;
+	response.age = 0;
+	response.payload = std::string_view();
+
+	std::string_view rest = line;
+	std::string_view responseType = nextField(rest, '|');
+
+	if (responseType == "DIALOGUE") {
+		// DIALOGUE|<dialogueId>|<index>
+		if (!parseInt(nextField(rest, '|'), response.dialogueId) ||
+			!parseInt(nextField(rest, '|'), response.index)) {
+			return false;
+		}
+		response.type = kResponse_Dialogue;
+		return true;
+	}
+	if (responseType == "COMMAND") {
+		// COMMAND|<commands>[|<deadline>|<age>]
+		response.type = kResponse_Command;
+		response.payload = nextField(rest, '|');
+		parseDeadline(rest, response);
+		return true;
+	}
+	if (responseType == "COMMAND_ID") {
+		// COMMAND_ID|<id>[|<deadline>|<age>]
+		if (!parseInt(nextField(rest, '|'), response.commandId) || response.commandId < 0) {
+			response.commandId = -1;
+			return false;
+		}
+		response.type = kResponse_CommandId;
+		parseDeadline(rest, response);
+		return true;
+	}
+	if (responseType == "PHRASE") {
+		// PHRASE|<id>
+		if (!parseInt(nextField(rest, '|'), response.commandId) || response.commandId <= 0) {
+			response.commandId = -1;
+			return false;
+		}
+		response.type = kResponse_Phrase;
+		return true;
+	}
+	if (responseType == "PAPYRUS_EVENT") {
+		// PAPYRUS_EVENT|<id>|<confidence>|<phrase>, the phrase is the rest of the line
+		if (!parseInt(nextField(rest, '|'), response.commandId) || !parseFloat(nextField(rest, '|'), response.confidence)) {
+			response.commandId = -1;
+			response.confidence = 0;
+			return false;
+		}
+		response.type = kResponse_PapyrusEvent;
+		response.payload = rest;
+		return true;
+	}
+	if (responseType == "REGISTER_COMMANDS") {
+		// REGISTER_COMMANDS|<id>|<commands>|<id>|<commands>...
+		response.type = kResponse_RegisterCommands;
+		response.payload = rest;
+		return true;
+	}
+	if (responseType == "EQUIP" && !rest.empty()) {
+		response.type = kResponse_Equip;
+		response.payload = nextField(rest, '|');
+		return true;
+	}
+	if (responseType == "READY") {
+		// READY|<stage>|<elapsed>
+		std::string_view stage = nextField(rest, '|');
+		if (stage.empty() || !parseInt(nextField(rest, '|'), response.elapsed)) {
+			return false;
+		}
+		response.type = kResponse_Ready;
+		response.payload = stage;
+		return true;
+	}
+	return false;
+}
+
+void SplitCommands(std::string_view payload, std::vector<std::string_view> &commands) {
+	while (!payload.empty()) {
+		std::string_view command = nextField(payload, ';');
+		if (!command.empty()) {
+			commands.push_back(command);
+		}
+	}
+}
+
+LineReader::LineReader(IPipe &pipe, IClock &clock, uint32_t pollInterval)
+	: pipe(pipe), clock(clock), pollInterval(pollInterval) {
+}
+
+bool LineReader::ReadLine(std::string &line) {
+	char buffer[4096];
+	size_t searchFrom = 0;
+
+	for (;;) {
+		size_t newline = workingLine.find('\n', searchFrom);
+		if (newline != std::string::npos) {
+			line.assign(workingLine, 0, newline);
+			// Keep any trailing data for the next ReadLine call
+			workingLine.erase(0, newline + 1);
+			return true;
+		}
+		searchFrom = workingLine.size();
+
+		int read = pipe.Read(buffer, sizeof(buffer));
+		if (read < 0) {
+			return false;
+		}
+		if (read == 0) {
+			clock.SleepMilliseconds(pollInterval);
+			continue;
+		}
+		workingLine.append(buffer, read);
+	}
+}
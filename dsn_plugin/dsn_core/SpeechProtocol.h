@@ -0,0 +1,157 @@
+#pragma once
+#include "DialogueArena.h"
+#include "Platform.h"
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Line based protocol between the plugin and the speech recognition service (DragonbornSpeaksNaturally.exe).
+// Every message is one line of '|' separated fields:
+//
+//   plugin -> service:  START_DIALOGUE|<dialogueId>|<hash>|<line>|<hash>|<line>...     (hash: see DialogueLineHash)
+//                       STOP_DIALOGUE
+//                       FAVORITES|<name>,<formId>,<itemId>,<isHanded>,<itemType>|...   (see FavoritesSnapshot.h)
+//                       REGISTER_PHRASES|<id>|<phrase>|<id>|<phrase>...                 (see PhraseRegistry.h)
+//                       UNREGISTER_PHRASES|<id>|<id>...
+//                       LISTEN_PAUSE|<reason>                                           (see ListenState.h)
+//                       LISTEN_RESUME
+//   service -> plugin:  DIALOGUE|<dialogueId>|<index>
+//                       COMMAND|<command>;<command>...[|<deadline>|<age>]
+//                       COMMAND_ID|<id>[|<deadline>|<age>]
+//                       REGISTER_COMMANDS|<id>|<command>;<command>...|<id>|<command>;<command>...
+//                       EQUIP|<formId>;<itemId>;<itemType>;<hand>                     (see EquipParser.h)
+//                       READY|<stage>|<milliseconds since the service started>
+//                       PHRASE|<id>
+//                       PAPYRUS_EVENT|<id>|<confidence>|<phrase>
+//
+// READY reports the startup stages of the service: "config" first, then "engine", "grammars" and "device"
+// in the order they complete, and "all" once commands can be recognized. "device" is sent again
+// when the recording device comes back after being lost.
+//
+// The optional fields of COMMAND are in milliseconds: the commands expire `deadline` after they were recognized
+// (0 for no deadline), and were recognized `age` before the service wrote the line.
+//
+// REGISTER_COMMANDS is sent when the command list is loaded (at startup and when the configuration is reloaded)
+// and replaces the previous table. A recognized phrase is then sent as COMMAND_ID with the id of its commands,
+// same optional fields as COMMAND. Commands that could not be registered are still sent with COMMAND.
+//
+// The phrases other plugins registered through the C API (see VoiceCommandApi.h) are added to the command mode
+// grammars of the service, PHRASE reports the recognition of one of them.
+//
+// PAPYRUS_EVENT follows the COMMAND (or COMMAND_ID) of a phrase tagged in the [PapyrusEvents] section of the ini,
+// with the id it is tagged with and the confidence of the recognition (0 to 1). It is sent to Papyrus scripts.
+//
+// LISTEN_PAUSE stops the recognition of the service until LISTEN_RESUME, its grammars stay loaded. The reason
+// (a menu name or "push-to-talk") is only logged.
+
+enum ResponseType
+{
+	kResponse_Unknown = 0,
+	kResponse_Dialogue,
+	kResponse_Command,
+	kResponse_Equip,
+	kResponse_Ready,
+	kResponse_CommandId,
+	kResponse_RegisterCommands,
+	kResponse_Phrase,
+	kResponse_PapyrusEvent
+};
+
+struct Response {
+	ResponseType type;
+	int dialogueId;            // kResponse_Dialogue
+	int index;                 // kResponse_Dialogue
+	int elapsed;               // kResponse_Ready: milliseconds since the service started
+	int commandId;             // kResponse_CommandId, kResponse_Phrase: the registered id, kResponse_PapyrusEvent: the tag
+	float confidence;          // kResponse_PapyrusEvent
+	int deadline;              // kResponse_Command, kResponse_CommandId: 0 if the commands never expire
+	int age;                   // kResponse_Command, kResponse_CommandId
+	std::string_view payload;  // kResponse_Command: "<command>;<command>...", kResponse_Equip: the equip item,
+	                           // kResponse_Ready: the stage, kResponse_RegisterCommands: "<id>|<commands>|<id>...",
+	                           // kResponse_PapyrusEvent: the phrase
+};
+
+// Parse a line received from the service. `response.payload` points into `line`.
+// Returns false (and kResponse_Unknown) for unknown or malformed messages.
+bool ParseResponse(std::string_view line, Response &response);
+
+// Split the payload of a COMMAND message, empty commands are skipped
+void SplitCommands(std::string_view payload, std::vector<std::string_view> &commands);
+
+// 64-bit FNV-1a hash of a dialogue line, sent with the line so the service can reuse the grammar it built
+// the last time the line was in a dialogue. Sent as 16 lowercase hex digits.
+inline uint64_t DialogueLineHash(const char *line, size_t length) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (uint8_t)line[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+// Build a START_DIALOGUE message for `topicCount` topics, `getTopic(i)` returns the text of topic i (a C string,
+// NULL for an empty topic). The arena is reset first and the returned message is valid until its next reset.
+// The topics are copied once, straight into a buffer of the size of the message.
+template<typename TopicGetter>
+std::string_view BuildStartDialogue(int dialogueId, size_t topicCount, TopicGetter getTopic, DialogueArena &arena) {
+	static const char kPrefix[] = "START_DIALOGUE|";
+	static const char kHexDigits[] = "0123456789abcdef";
+	const size_t prefixLength = sizeof(kPrefix) - 1;
+	const size_t hashLength = 16;
+
+	char id[16];
+	size_t idLength = std::to_chars(id, id + sizeof(id), dialogueId).ptr - id;
+
+	size_t size = prefixLength + idLength;
+	for (size_t i = 0; i < topicCount; i++) {
+		const char *topic = getTopic(i);
+		size += 1 + hashLength + 1 + (topic ? strlen(topic) : 0);
+	}
+
+	arena.Reset();
+	char *message = arena.Allocate(size);
+	char *out = message;
+	memcpy(out, kPrefix, prefixLength);
+	out += prefixLength;
+	memcpy(out, id, idLength);
+	out += idLength;
+	for (size_t i = 0; i < topicCount; i++) {
+		const char *topic = getTopic(i);
+		size_t length = topic ? strlen(topic) : 0;
+		uint64_t hash = DialogueLineHash(topic, length);
+
+		*out++ = '|';
+		for (int digit = hashLength - 1; digit >= 0; digit--) {
+			out[digit] = kHexDigits[hash & 0xF];
+			hash >>= 4;
+		}
+		out += hashLength;
+		*out++ = '|';
+		if (length > 0) {
+			memcpy(out, topic, length);
+			out += length;
+		}
+	}
+	return std::string_view(message, size);
+}
+
+// Splits the byte stream sent by the service into lines
+class LineReader
+{
+public:
+	static const uint32_t kDefaultPollInterval = 200;
+
+	LineReader(IPipe &pipe, IClock &clock, uint32_t pollInterval = kDefaultPollInterval);
+
+	// Read the next line without the '\n', waiting `pollInterval` milliseconds between reads
+	// when no data is available. Returns false if the pipe is closed.
+	bool ReadLine(std::string &line);
+
+private:
+	IPipe &pipe;
+	IClock &clock;
+	uint32_t pollInterval;
+	std::string workingLine;  // received data after the last returned line
+};
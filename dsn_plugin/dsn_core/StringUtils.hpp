@@ -3,7 +3,7 @@
 #include <sstream>
 #include <vector>
 
-static std::vector<std::string> splitParams(std::string s) {
+inline static std::vector<std::string> splitParams(std::string s) {
 	for (size_t i = 0; i<s.size(); i++) {
 		// replace blank characters to space
 		if (s[i] == '\t' || s[i] == '\n' || s[i] == '\r' ||
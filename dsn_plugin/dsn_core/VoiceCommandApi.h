@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+
+// C API of dragonborn_speaks_naturally.dll for other native (SKSE) plugins: register voice phrases and have
+// a callback run on the game thread when one is recognized, without going through the console.
+//
+// The functions are exported by name (see exports.def). Get them once the DLL is loaded, e.g.
+//
+//   HMODULE dsn = GetModuleHandleA("dragonborn_speaks_naturally.dll");
+//   DSN_RegisterPhrase_t registerPhrase = (DSN_RegisterPhrase_t)GetProcAddress(dsn, "DSN_RegisterPhrase");
+//
+// and check DSN_GetApiVersion() first. The functions can be called from any thread. Registrations are sent
+// to the speech recognition service once per frame, so registering thousands of phrases in a row builds
+// their grammars in one go. They are kept when the service restarts or reloads its configuration.
+
+#define DSN_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Called on the game thread each time the phrase `phraseId` is recognized
+typedef void (*DSN_PhraseCallback)(uint32_t phraseId, void *userData);
+
+// Returns DSN_API_VERSION
+uint32_t DSN_GetApiVersion(void);
+
+// Register a phrase recognized in command mode (outside dialogues). A '|' or a line break in the phrase is read
+// as a space. Returns the id of the phrase, never reused, or 0 if the phrase is empty or `callback` is NULL.
+uint32_t DSN_RegisterPhrase(const char *phrase, DSN_PhraseCallback callback, void *userData);
+
+// Unregister a phrase, its callback is not called anymore once this returns (unless it is running on the
+// game thread). Returns 0 if `phraseId` is not registered.
+int DSN_UnregisterPhrase(uint32_t phraseId);
+
+typedef uint32_t (*DSN_GetApiVersion_t)(void);
+typedef uint32_t (*DSN_RegisterPhrase_t)(const char *phrase, DSN_PhraseCallback callback, void *userData);
+typedef int (*DSN_UnregisterPhrase_t)(uint32_t phraseId);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,6 +2,9 @@
 #include "Log.h"
 #include "SkyrimType.h"
 #include "Equipper.h"
+#include "EquipBatch.h"
+#include "ConsoleCommandRunner.h"
+#include "DSNMenuManager.h"
 #include "SpeechRecognitionClient.h"
 #include "skse64/GameAPI.h"
 #include "skse64/GameRTTI.h"
@@ -10,7 +13,7 @@
 #include "skse64/GameTypes.h"
 #include "skse64/PapyrusActor.h"
 #include "skse64/GameInput.h"
-#include "skse64/HashUtil.h"
+#include "skse64/GameEvents.h"
 
 FavoritesMenuManager* FavoritesMenuManager::instance = NULL;
 
@@ -20,27 +23,58 @@ FavoritesMenuManager* FavoritesMenuManager::getInstance() {
 	return instance;
 }
 
-FavoritesMenuManager::FavoritesMenuManager(){}
-
-SInt32 fmCalcItemId(TESForm * form, BaseExtraList * extraList)
-{
-	if (!form || !extraList)
-		return 0;
+FavoritesMenuManager::FavoritesMenuManager() : refreshRequested(false) {}
+
+// Menus in which favorites or the favorited items can change
+static const char * FAVORITES_CHANGING_MENUS[] = {
+	"FavoritesMenu",
+	"InventoryMenu",
+	"MagicMenu",
+	"ContainerMenu",
+	"BarterMenu",
+	"GiftMenu",
+	"Loading Menu"	// a game was loaded
+};
 
-	const char * name = extraList->GetDisplayName(form);
+class FavoritesRefreshSink : public BSTEventSink<MenuOpenCloseEvent> {
+	EventResult ReceiveEvent(MenuOpenCloseEvent * evn, EventDispatcher<MenuOpenCloseEvent> * dispatcher) override {
+		if (evn && !evn->opening && evn->menuName.data) {
+			for (const char *menuName : FAVORITES_CHANGING_MENUS) {
+				if (strcmp(evn->menuName.data, menuName) == 0) {
+					FavoritesMenuManager::getInstance()->RequestRefresh();
+					break;
+				}
+			}
+		}
+		return kEvent_Continue;
+	}
+};
 
-	// No name in extra data? Use base form name
-	if (!name)
-	{
-		TESFullName* pFullName = DYNAMIC_CAST(form, TESForm, TESFullName);
-		if (pFullName)
-			name = pFullName->name.data;
+bool FavoritesMenuManager::RegisterEventSinks() {
+	MenuManager *menuManager = DSNMenuManager::GetSingleton();
+	if (!menuManager) {
+		static bool logged = false;
+		if (!logged) {
+			Log::info("MenuManager not found yet, favorites refresh on menu close will be registered later");
+			logged = true;
+		}
+		return false;
 	}
 
-	if (!name)
-		return 0;
+	static FavoritesRefreshSink favoritesRefreshSink;
+	menuManager->MenuOpenCloseEventDispatcher()->AddEventSink(&favoritesRefreshSink);
+	Log::info("FavoritesRefreshSink Initialized");
+	return true;
+}
+
+void FavoritesMenuManager::RequestRefresh() {
+	refreshRequested = true;
+}
 
-	return (SInt32)HashUtil::CRC32(name, form->formID & 0x00FFFFFF);
+void FavoritesMenuManager::RefreshIfRequested() {
+	if (refreshRequested.exchange(false)) {
+		RefreshFavorites();
+	}
 }
 
 bool IsEquipmentSingleHanded(TESForm *item) {
@@ -55,54 +89,39 @@ bool IsEquipmentSingleHanded(TESForm *item) {
 	return (equipSlot == GetLeftHandSlot() || equipSlot == GetRightHandSlot());
 }
 
-std::vector<FavoriteMenuItem> ExtractFavorites(InventoryEntryData * inv) {
-	std::vector<FavoriteMenuItem> menuItems;
-	ExtendDataList* pExtendList = inv->extendDataList;
-
-	if (pExtendList)
-	{
-		bool isHanded = IsEquipmentSingleHanded(inv->type);
-		TESFullName *baseFullname = DYNAMIC_CAST(inv->type, TESForm, TESFullName);
-		std::string baseName = std::string(baseFullname->name.data);
-		SInt32 n = 0;
-		BaseExtraList* itemExtraDataList = pExtendList->GetNthItem(n);
-		while (itemExtraDataList)
-		{
-			// Check if item is hotkeyed
-			if (ExtraHotkey * extraHotkey = static_cast<ExtraHotkey*>(itemExtraDataList->GetByType(kExtraData_Hotkey)))
-			{
-				std::string name = baseName;
-				const char* modifiedName = itemExtraDataList->GetDisplayName(inv->type);
-				if (modifiedName) {
-					name = std::string(modifiedName);
-				}
-				SInt32 itemId = fmCalcItemId(inv->type, itemExtraDataList);
-
-				if (ExtraTextDisplayData * textDisplayData = static_cast<ExtraTextDisplayData*>(itemExtraDataList->GetByType(kExtraData_TextDisplayData)))
-				{
-					if (textDisplayData->name.data) {
-						name = std::string(textDisplayData->name.data);
-						const char* displayName = itemExtraDataList->GetDisplayName(inv->type);
-						itemId = (SInt32)HashUtil::CRC32(displayName, inv->type->formID & 0x00FFFFFF);
-					}
-				}
-
-				FavoriteMenuItem entry = {
-					inv->type->formID,
-					itemId,
-					name,
-					1, // Equipment
-					isHanded };
+// Access to the player's inventory for ExtractFavorites()
+struct SkseInventoryTraits {
+	typedef InventoryEntryData Entry;
+	typedef TESForm Form;
+	typedef BaseExtraList ExtraList;
 
-				menuItems.push_back(entry);
-			}
-			n++;
-			itemExtraDataList = pExtendList->GetNthItem(n);
-		}
+	static Form * GetForm(Entry *entry) {
+		return entry->type;
 	}
-
-	return menuItems;
-}
+	static uint32_t GetFormId(Form *form) {
+		return form->formID;
+	}
+	static const char * GetFullName(Form *form) {
+		TESFullName *fullName = DYNAMIC_CAST(form, TESForm, TESFullName);
+		return fullName ? fullName->name.data : NULL;
+	}
+	static bool IsSingleHanded(Form *form) {
+		return IsEquipmentSingleHanded(form);
+	}
+	static ExtraList * GetNthExtraList(Entry *entry, int32_t n) {
+		return entry->extendDataList ? entry->extendDataList->GetNthItem(n) : NULL;
+	}
+	static bool HasHotkey(ExtraList *extraList) {
+		return extraList->HasType(kExtraData_Hotkey);
+	}
+	static const char * GetDisplayName(ExtraList *extraList, Form *form) {
+		return extraList->GetDisplayName(form);
+	}
+	static const char * GetTextDisplayName(ExtraList *extraList) {
+		ExtraTextDisplayData *textDisplayData = static_cast<ExtraTextDisplayData*>(extraList->GetByType(kExtraData_TextDisplayData));
+		return textDisplayData ? textDisplayData->name.data : NULL;
+	}
+};
 
 void FavoritesMenuManager::RefreshFavorites() {
 
@@ -117,17 +136,10 @@ void FavoritesMenuManager::RefreshFavorites() {
 		if (pContainerChanges && pContainerChanges->data) {
 			for (EntryDataList::Iterator it = pContainerChanges->data->objList->Begin(); !it.End(); ++it)
 			{
+				// Single pass over the inventory, ExtractFavorites() only keeps the hotkeyed extra lists
 				InventoryEntryData *inv = it.Get();
-				TESForm* type = inv->type;
-				if (type) {
-					HotkeyData data = pContainerChanges->FindHotkey(type);
-					if (data.pHotkey)
-					{
-						std::vector<FavoriteMenuItem> itemEntries = ExtractFavorites(inv);
-						for (int i = 0; i < itemEntries.size(); i++) {
-							favorites.push_back(itemEntries[i]);
-						}
-					}
+				if (inv) {
+					ExtractFavorites<SkseInventoryTraits>(inv, favorites);
 				}
 			}
 		}
@@ -166,45 +178,15 @@ void FavoritesMenuManager::RefreshFavorites() {
 			}
 		}
 
-		std::string command = "FAVORITES";
-		for (int i = 0; i < favorites.size(); i++) {
-			FavoriteMenuItem favorite = favorites[i];
-			command += "|" + favorite.fullname + "," + std::to_string(favorite.TESFormId) + "," + std::to_string(favorite.itemId) + "," + std::to_string(favorite.isHanded) + "," + std::to_string(favorite.itemType);
-		}
+		BuildFavoritesCommand(favorites, favoritesCommand);
 
-		if (lastFavoritesCommand != command) {
-			SpeechRecognitionClient::getInstance()->WriteLine(command);
-			lastFavoritesCommand = command;
+		if (lastFavoritesCommand != favoritesCommand) {
+			SpeechRecognitionClient::getInstance()->WriteLine(favoritesCommand);
+			lastFavoritesCommand.swap(favoritesCommand);
 		}
 	}
 }
 
-static std::vector<std::string> split(const std::string &s, char delim) {
-	std::stringstream ss(s);
-	std::string item;
-	std::vector<std::string> tokens;
-	while (std::getline(ss, item, delim)) {
-		tokens.push_back(item);
-	}
-	return tokens;
-}
-
-EquipItem parseEquipItem(std::string command) {
-	std::vector<std::string> tokens = split(command, ';');
-
-	char* formId = (char*)tokens[0].c_str();
-	char* end = formId + strlen(formId);
-
-	EquipItem item = {
-		(UInt32)std::strtoul(formId, &end, 10),
-		(SInt32)std::atoi(tokens[1].c_str()),
-		(UInt8)std::atoi(tokens[2].c_str()),
-		(SInt32)std::atoi(tokens[3].c_str())
-	};
-
-	return item;
-}
-
 enum
 {
 	kSlotId_Default = 0,
@@ -213,42 +195,95 @@ enum
 };
 
 
+static EquipSlotMask getEquipSlotMask(TESForm *form, const EquipItem &equipItem) {
+	switch (equipItem.itemType) {
+	case 1: // Item
+		if (TESObjectARMO *armor = DYNAMIC_CAST(form, TESForm, TESObjectARMO)) {
+			return armor->bipedObject.GetSlotMask() & kEquipSlot_Biped;
+		}
+		if (form->IsAmmo()) {
+			return kEquipSlot_Ammo;
+		}
+		if (form->IsWeapon()) {
+			// Without a hand the game picks the slot, so it is unknown here
+			if (equipItem.hand == kSlotId_Right)
+				return kEquipSlot_RightHand;
+			if (equipItem.hand == kSlotId_Left)
+				return kEquipSlot_LeftHand;
+		}
+		return 0; // potions, scrolls, ...: every command counts
+	case 2: // Spell
+		if (equipItem.hand == kSlotId_Right)
+			return kEquipSlot_RightHand;
+		if (equipItem.hand == kSlotId_Left)
+			return kEquipSlot_LeftHand;
+		return kEquipSlot_RightHand | kEquipSlot_LeftHand;
+	case 3: // Shout
+		return kEquipSlot_Voice;
+	}
+	return 0;
+}
+
+static void equipSpellByConsole(UInt32 formId, const char *hand) {
+	char command[64];
+	snprintf(command, sizeof(command), "player.equipspell %x %s", (unsigned int)formId, hand);
+	ConsoleCommandRunner::RunCommand(command);
+}
+
+static void equipShoutByConsole(UInt32 formId) {
+	char command[64];
+	snprintf(command, sizeof(command), "player.equipshout %x", (unsigned int)formId);
+	ConsoleCommandRunner::RunCommand(command);
+}
+
 void FavoritesMenuManager::ProcessEquipCommands() {
 
 	PlayerCharacter *player = (*g_thePlayer);
 	SpeechRecognitionClient *client = SpeechRecognitionClient::getInstance();
 	EquipManager *equipManager = EquipManager::GetSingleton();
-	std::string equipStr = client->PopEquip();
-	if (player && equipManager && equipStr != "") {
-		EquipItem equipItem = parseEquipItem(equipStr);
+
+	// Drain every equip command received since the last frame
+	equipBatch.clear();
+	client->PopEquips(equipBatch);
+	if (equipBatch.empty() || !player || !equipManager) {
+		return;
+	}
+
+	pendingEquips.clear();
+	for (const EquipItem &equipItem : equipBatch) {
 		TESForm * form = LookupFormByID(equipItem.TESFormId);
-		std::string hand = equipItem.hand == 1 ? "right" : "left";
 		if (form) {
-			std::stringstream formIdAsHex;
-
-			switch (equipItem.itemType) {
-			case 1: // Item
-				Equipper::EquipItem(player, form, equipItem.itemId, equipItem.hand);
-				break;
-			case 2: // Spell
-				formIdAsHex << std::hex << equipItem.TESFormId;
-				if (equipItem.hand == 0) {
-					client->EnqueueCommand("player.equipspell " + formIdAsHex.str() + " left");
-					client->EnqueueCommand("player.equipspell " + formIdAsHex.str() + " right");
-				} else {
-					client->EnqueueCommand("player.equipspell " + formIdAsHex.str() + " " + hand);
-				}
-				break;
-			case 3: // Shout
-				formIdAsHex << std::hex << equipItem.TESFormId;
-				client->EnqueueCommand("player.equipshout " + formIdAsHex.str());
-				PlayerControls * controls = PlayerControls::GetSingleton();
-				break;
-			}
+			PendingEquip equip = { equipItem, getEquipSlotMask(form, equipItem), form, false };
+			pendingEquips.push_back(equip);
 		}
-
 	}
-}
-
 
+	// Several equips to the same slot in one batch (e.g. a loadout macro): only the last one wins
+	size_t dropped = CoalesceEquips(pendingEquips);
+	if (dropped > 0) {
+		Log::info("Skipped " + std::to_string(dropped) + " superseded equip command(s) of " + std::to_string(equipBatch.size()));
+	}
 
+	for (const PendingEquip &equip : pendingEquips) {
+		const EquipItem &equipItem = equip.item;
+		TESForm * form = (TESForm *)equip.form;
+
+		switch (equipItem.itemType) {
+		case 1: // Item
+			Equipper::EquipItem(player, form, equipItem.itemId, equipItem.hand);
+			break;
+		case 2: // Spell
+			// Run in this frame instead of queueing the console command for the next ones
+			if (equipItem.hand == kSlotId_Default) {
+				equipSpellByConsole(equipItem.TESFormId, "left");
+				equipSpellByConsole(equipItem.TESFormId, "right");
+			} else {
+				equipSpellByConsole(equipItem.TESFormId, equipItem.hand == kSlotId_Right ? "right" : "left");
+			}
+			break;
+		case 3: // Shout
+			equipShoutByConsole(equipItem.TESFormId);
+			break;
+		}
+	}
+}
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include "common/IPrefix.h"
 #include "skse64/GameTypes.h"
+#include "EquipBatch.h"
+#include "FavoritesSnapshot.h"
 
 struct FakeMagicFavorites {
 	UInt64 vtable;
@@ -12,21 +15,6 @@ struct FakeMagicFavorites {
 	UnkFormArray	hotkeys;	// 28
 };
 
-struct FavoriteMenuItem {
-	UInt32 TESFormId;
-	SInt32 itemId;
-	std::string fullname;
-	UInt8 itemType;
-	bool isHanded;	// True if user must specify "left" or "right" in equip commands
-};
-
-struct EquipItem {
-	UInt32 TESFormId;
-	SInt32 itemId;
-	UInt8 itemType;
-	SInt32 hand; // 0 = no hand specified, 1 = right hand, 2 = left hand
-};
-
 class FavoritesMenuManager
 {
 	static FavoritesMenuManager* instance;
@@ -35,8 +23,19 @@ public:
 	static FavoritesMenuManager* getInstance();
 	void RefreshFavorites();
 	void ProcessEquipCommands();
+
+	// Refresh the favorites when a menu that can change them is closed or a game is loaded.
+	// Returns false if the MenuManager does not exist yet, to be called again on a later frame.
+	bool RegisterEventSinks();
+	// Thread-safe, the refresh is done by the next RefreshIfRequested() call on the game thread
+	void RequestRefresh();
+	void RefreshIfRequested();
 private:
 	FavoritesMenuManager();
 	std::vector<FavoriteMenuItem> favorites;
+	std::string favoritesCommand;
 	std::string lastFavoritesCommand;
+	std::atomic<bool> refreshRequested;
+	std::vector<EquipItem> equipBatch;
+	std::vector<PendingEquip> pendingEquips;
 };
\ No newline at end of file
@@ -6,11 +6,14 @@
 #include "skse64/ScaleformMovie.h"
 #include "skse64/ScaleformValue.h"
 #include "skse64/GameInput.h"
+#include "skse64/GameEvents.h"
 #include "skse64_common/BranchTrampoline.h"
 #include "xbyak.h"
 #include "SkyrimType.h"
 #include "ConsoleCommandRunner.h"
 #include "FavoritesMenuManager.h"
+#include "DSNMenuManager.h"
+#include "PapyrusPhraseEvents.h"
 
 class RunCommandSink;
 
@@ -35,42 +38,38 @@ static void __cdecl Hook_Invoke(GFxMovieView* movie, char * gfxMethod, GFxValue*
 				numTopics = (argc - 2) / 3;
 				desiredTopicIndex = -1;
 				dialogueMenu = movie;
-				std::vector<std::string> lines;
-				for (int j = 1; j < argc - 1; j = j + 3)
-				{
-					GFxValue dialogueLine = argv[j];
-					const char* dialogueLineStr = dialogueLine.data.string;
-					lines.push_back(std::string(dialogueLineStr));
-				}
-
-				DialogueList dialogueList;
-				dialogueList.lines = lines;
-				SpeechRecognitionClient::getInstance()->StartDialogue(dialogueList);
+				// The topics follow the command, 3 values per topic starting with its text: argv[1], argv[4]... before argv[argc - 1]
+				SpeechRecognitionClient::getInstance()->StartDialogue(argc / 3, [argv](size_t topic) {
+					return argv[1 + topic * 3].data.string;
+				});
 			}
 			else if (g_SkyrimType == VR && strcmp(command, "UpdatePlayerInfo") == 0)
 			{
-				FavoritesMenuManager::getInstance()->RefreshFavorites();
+				FavoritesMenuManager::getInstance()->RequestRefresh();
 			}
 		}
 	}
 }
 
 static void __cdecl Hook_PostLoad() {
-	if (g_SkyrimType == VR) {
-		FavoritesMenuManager::getInstance()->RefreshFavorites();
-	}
+	// VR only, SkyrimSE uses the "Loading Menu" close event (see FavoritesRefreshSink)
+	FavoritesMenuManager::getInstance()->RequestRefresh();
 }
 
 static void runCommand() {
-	std::string command = SpeechRecognitionClient::getInstance()->PopCommand();
+	SpeechRecognitionClient *client = SpeechRecognitionClient::getInstance();
+	std::string command = client->PopCommand();
 	if (command != "") {
 		ConsoleCommandRunner::RunCommand(command);
 		Log::info("run command: " + command);
 	}
+	client->UpdatePhrases();
+	client->UpdatePushToTalk();
+	PapyrusPhraseEvents::Update();
 
-	if (g_SkyrimType == VR) {
-		FavoritesMenuManager::getInstance()->ProcessEquipCommands();
-	}
+	FavoritesMenuManager *favoritesMenuManager = FavoritesMenuManager::getInstance();
+	favoritesMenuManager->RefreshIfRequested();
+	favoritesMenuManager->ProcessEquipCommands();
 }
 
 class RunCommandSink : public BSTEventSink<InputEvent> {
@@ -80,6 +79,29 @@ class RunCommandSink : public BSTEventSink<InputEvent> {
 	}
 };
 
+// Pauses the speech recognition in loading screens and the menus of pauseInMenus
+class ListenStateSink : public BSTEventSink<MenuOpenCloseEvent> {
+	EventResult ReceiveEvent(MenuOpenCloseEvent * evn, EventDispatcher<MenuOpenCloseEvent> * dispatcher) override {
+		if (evn && evn->menuName.data) {
+			SpeechRecognitionClient::getInstance()->MenuOpenClose(evn->menuName.data, evn->opening);
+		}
+		return kEvent_Continue;
+	}
+};
+
+// Returns false if the MenuManager does not exist yet
+static bool registerListenStateSink() {
+	MenuManager *menuManager = DSNMenuManager::GetSingleton();
+	if (!menuManager) {
+		return false;
+	}
+
+	static ListenStateSink listenStateSink;
+	menuManager->MenuOpenCloseEventDispatcher()->AddEventSink(&listenStateSink);
+	Log::info("ListenStateSink Initialized");
+	return true;
+}
+
 static void __cdecl Hook_Loop()
 {
 	if (dialogueMenu != NULL)
@@ -127,6 +149,16 @@ static void __cdecl Hook_Loop()
 	}
 	else
 	{
+		// Retried every frame until the MenuManager exists
+		static bool favoritesSinkInited = false;
+		if (!favoritesSinkInited) {
+			favoritesSinkInited = FavoritesMenuManager::getInstance()->RegisterEventSinks();
+		}
+		static bool listenStateSinkInited = false;
+		if (!listenStateSinkInited) {
+			listenStateSinkInited = registerListenStateSink();
+		}
+
 		if (g_SkyrimType == VR) {
 			runCommand();
 		}
@@ -208,6 +240,7 @@ void Hooks_Inject(void)
 
 	/***
 	Post Load HOOK - VR Only
+	SkyrimSE has no address for it, the favorites are refreshed when the "Loading Menu" closes instead.
 	**/
 	if (g_SkyrimType == VR) {
 		RelocAddr<uintptr_t> kHook_LoadEvent_Enter(LOAD_EVENT_ENTER_ADDR[g_SkyrimType]);
@@ -0,0 +1,97 @@
+#include "PapyrusPhraseEvents.h"
+#include "SpeechRecognitionClient.h"
+#include "Log.h"
+#include "skse64/GameForms.h"
+#include "skse64/PapyrusEvents.h"
+#include "skse64/PapyrusNativeFunctions.h"
+#include "skse64/PapyrusVM.h"
+
+bool PapyrusPhraseEvents::functionsRegistered = false;
+std::vector<PhraseEvent> PapyrusPhraseEvents::batch;
+
+// The forms registered by scripts and the name of their event, like the registrations of SKSE's ModEvents
+static RegistrationSetHolder<ModCallbackParameters> phraseEventRegs;
+
+static const char *kDefaultEventName = "DSN_PhraseRecognized";
+
+// Queues the event of one recognition on each registered form: <event>(string phrase, int id, float confidence)
+class PhraseEventFunctor : public IFunctionArguments
+{
+public:
+	PhraseEventFunctor(const PhraseEvent &event)
+		: phrase(event.phrase.c_str()), id(event.id), confidence(event.confidence) {}
+
+	virtual bool Copy(Output *dst) {
+		dst->Resize(3);
+		dst->Get(0)->SetString(phrase.data);
+		dst->Get(1)->SetInt(id);
+		dst->Get(2)->SetFloat(confidence);
+		return true;
+	}
+
+	void operator() (const EventRegistration<ModCallbackParameters> &reg) {
+		VMClassRegistry *registry = (*g_skyrimVM)->GetClassRegistry();
+		registry->QueueEvent(reg.handle, &reg.params.callbackName, this);
+	}
+
+private:
+	BSFixedString phrase;
+	SInt32 id;
+	float confidence;
+};
+
+namespace papyrusDSN
+{
+	void RegisterForPhraseEvents(StaticFunctionTag *base, TESForm *receiver, BSFixedString eventName) {
+		if (!receiver) {
+			return;
+		}
+		ModCallbackParameters params;
+		params.callbackName = eventName.data && eventName.data[0] ? eventName : BSFixedString(kDefaultEventName);
+		phraseEventRegs.Register<TESForm>(receiver->GetFormType(), receiver, &params);
+	}
+
+	void UnregisterForPhraseEvents(StaticFunctionTag *base, TESForm *receiver) {
+		if (!receiver) {
+			return;
+		}
+		phraseEventRegs.Unregister<TESForm>(receiver->GetFormType(), receiver);
+	}
+
+	UInt32 GetApiVersion(StaticFunctionTag *base) {
+		return 1;
+	}
+
+	void RegisterFuncs(VMClassRegistry *registry) {
+		registry->RegisterFunction(
+			new NativeFunction2 <StaticFunctionTag, void, TESForm *, BSFixedString>("RegisterForPhraseEvents", "DSN", RegisterForPhraseEvents, registry));
+		registry->RegisterFunction(
+			new NativeFunction1 <StaticFunctionTag, void, TESForm *>("UnregisterForPhraseEvents", "DSN", UnregisterForPhraseEvents, registry));
+		registry->RegisterFunction(
+			new NativeFunction0 <StaticFunctionTag, UInt32>("GetApiVersion", "DSN", GetApiVersion, registry));
+
+		registry->SetFunctionFlags("DSN", "RegisterForPhraseEvents", VMClassRegistry::kFunctionFlag_NoWait);
+		registry->SetFunctionFlags("DSN", "UnregisterForPhraseEvents", VMClassRegistry::kFunctionFlag_NoWait);
+		registry->SetFunctionFlags("DSN", "GetApiVersion", VMClassRegistry::kFunctionFlag_NoWait);
+	}
+}
+
+void PapyrusPhraseEvents::Update() {
+	// This DLL is not loaded by SKSE, the functions are registered directly in the VM.
+	// It exists before the main menu, so before any script can use the DSN script.
+	if (!functionsRegistered) {
+		if (!*g_skyrimVM) {
+			return;
+		}
+		papyrusDSN::RegisterFuncs((*g_skyrimVM)->GetClassRegistry());
+		functionsRegistered = true;
+		Log::info("Registered the native functions of the DSN Papyrus script");
+	}
+
+	// All the events of the frame are sent at once
+	SpeechRecognitionClient::getInstance()->PopPhraseEvents(batch);
+	for (const PhraseEvent &event : batch) {
+		PhraseEventFunctor functor(event);
+		phraseEventRegs.ForEach(functor);
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "common/IPrefix.h"
+#include <vector>
+#include "PhraseEventQueue.h"
+
+// Papyrus events of the phrases tagged in the [PapyrusEvents] section of the ini (see papyrus/DSN.psc).
+//
+// Scripts register a form with DSN.RegisterForPhraseEvents(), the event (DSN_PhraseRecognized by default) is then
+// queued on it with the phrase, its tag and the confidence of the recognition. The registrations are not saved
+// with the game: scripts register again in OnPlayerLoadGame.
+class PapyrusPhraseEvents
+{
+public:
+	// Called once per frame on the game thread: registers the native functions of the DSN script once the
+	// Papyrus VM exists, then sends the events of the phrases recognized since the last frame
+	static void Update();
+
+private:
+	static bool functionsRegistered;
+	static std::vector<PhraseEvent> batch;
+};
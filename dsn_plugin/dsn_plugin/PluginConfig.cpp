@@ -0,0 +1,51 @@
+#include "PluginConfig.h"
+#include "Log.h"
+#include <Windows.h>
+
+static const char *CONFIG_FILE_NAME = "DragonbornSpeaksNaturally.ini";
+
+// Same search directories as the service (dsn_service/Configuration.cs), relative to the game's executable
+static const char *SEARCH_DIRECTORIES[] = {
+	"Data\\Plugins\\Sumwunn\\",
+	""
+};
+
+const std::string & PluginConfig::GetIniFilePath() {
+	static std::string iniFilePath;
+	static bool resolved = false;
+
+	if (!resolved) {
+		resolved = true;
+		for (const char *directory : SEARCH_DIRECTORIES) {
+			std::string path = std::string(directory) + CONFIG_FILE_NAME;
+			char fullPath[MAX_PATH] = { 0 };
+			// GetPrivateProfileString() looks for relative paths in the Windows directory
+			if (GetFullPathNameA(path.c_str(), MAX_PATH, fullPath, NULL) > 0 &&
+				GetFileAttributesA(fullPath) != INVALID_FILE_ATTRIBUTES) {
+				iniFilePath = fullPath;
+				Log::info("Plugin config: " + iniFilePath);
+				break;
+			}
+		}
+	}
+	return iniFilePath;
+}
+
+std::string PluginConfig::GetString(const char *section, const char *key, const char *defaultValue) {
+	const std::string &path = GetIniFilePath();
+	if (path.empty()) {
+		return defaultValue;
+	}
+
+	char value[1024] = { 0 };
+	GetPrivateProfileStringA(section, key, defaultValue, value, sizeof(value), path.c_str());
+	return value;
+}
+
+int PluginConfig::GetInt(const char *section, const char *key, int defaultValue) {
+	const std::string &path = GetIniFilePath();
+	if (path.empty()) {
+		return defaultValue;
+	}
+	return GetPrivateProfileIntA(section, key, defaultValue, path.c_str());
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+
+// Settings of the plugin, read from the same DragonbornSpeaksNaturally.ini as the speech recognition service
+class PluginConfig
+{
+public:
+	static std::string GetString(const char *section, const char *key, const char *defaultValue = "");
+	static int GetInt(const char *section, const char *key, int defaultValue);
+
+private:
+	static const std::string & GetIniFilePath();
+};
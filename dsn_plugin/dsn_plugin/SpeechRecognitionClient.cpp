@@ -1,200 +1,193 @@
 #include "SpeechRecognitionClient.h"
 #include "ConsoleCommandRunner.h"
+#include "SpeechProtocol.h"
+#include "PluginConfig.h"
+#include "KeyScanCode.h"
 #include "Log.h"
-#include <io.h>
-#include <fcntl.h>
-
-#define BUFSIZE 4096 
-
-HANDLE g_hChildStd_IN_Rd = NULL;
-HANDLE g_hChildStd_IN_Wr = NULL;
-HANDLE g_hChildStd_OUT_Rd = NULL;
-HANDLE g_hChildStd_OUT_Wr = NULL;
-
-static std::vector<std::string> split(const std::string &s, char delim) {
-	std::stringstream ss(s);
-	std::string item;
-	std::vector<std::string> tokens;
-	while (std::getline(ss, item, delim)) {
-		tokens.push_back(item);
-	}
-	return tokens;
-}
-
-SpeechRecognitionClient* SpeechRecognitionClient::instance = NULL;
 
 SpeechRecognitionClient* SpeechRecognitionClient::getInstance() {
-	if (!instance)
-		instance = new SpeechRecognitionClient();
+	// Also called by other plugins through VoiceCommandApi, from any thread: the initialization of a
+	// function-local static runs once even when threads race on the first call
+	static SpeechRecognitionClient* instance = new SpeechRecognitionClient();
 	return instance;
 }
 
+static WindowsClock clientClock;
+
 SpeechRecognitionClient::SpeechRecognitionClient()
+	: dispatcher(clientClock, ConsoleCommandRunner::TryRunCustomCommand),
+	writer(clientClock, [this](std::string_view line) {
+		if (recorder) {
+			recorder->Record(kSessionLine_Outbound, line);
+		}
+	})
 {
+	dispatcher.SetRepeatWindow(PluginConfig::GetInt("SpeechRecognition", "commandRepeatWindow", CommandDebouncer::kDefaultWindow));
+
+	listenState.SetPausingMenus(PluginConfig::GetString("SpeechRecognition", "pauseInMenus", ListenState::kDefaultPausingMenus));
+	std::string pushToTalk = PluginConfig::GetString("SpeechRecognition", "pushToTalkKey");
+	if (!pushToTalk.empty()) {
+		pushToTalkKey = GetKeyScanCode(pushToTalk);
+		if (pushToTalkKey != 0) {
+			listenState.SetPushToTalk(true, PluginConfig::GetInt("SpeechRecognition", "pushToTalkReleaseDelay", ListenState::kDefaultReleaseDelay));
+			Log::info("Push-to-talk key: " + pushToTalk);
+		}
+		else {
+			Log::info("Unknown push-to-talk key " + pushToTalk + ", always listening");
+		}
+	}
+
+	// Opt-in recording of the session, for reproducing it with dsn_replay
+	std::string recordFile = PluginConfig::GetString("Debug", "recordSessionFile");
+	if (!recordFile.empty()) {
+		recorder = new SessionRecorder(clientClock);
+		if (recorder->Open(recordFile)) {
+			Log::info("Recording speech recognition session to " + recordFile);
+		}
+		else {
+			Log::info("Unable to open session recording file " + recordFile);
+			delete recorder;
+			recorder = NULL;
+		}
+	}
 }
 
 SpeechRecognitionClient::~SpeechRecognitionClient()
 {
 }
 
-void SpeechRecognitionClient::StopDialogue() {
-	WriteLine("STOP_DIALOGUE");
+void SpeechRecognitionClient::Connect(IPipe *servicePipe) {
+	dispatcher.ServiceLaunched();
+
+	std::lock_guard<std::mutex> lock(pipeLock);
+	pipe = servicePipe;
+	writer.SetPipe(pipe);
+
+	std::vector<std::string> restoreLines;
+	state.GetRestoreLines(restoreLines);
+	for (const std::string &line : restoreLines) {
+		writer.Enqueue(line);
+	}
 }
 
-void SpeechRecognitionClient::StartDialogue(DialogueList list) {
-	this->currentDialogueId++;
-	this->selectedIndex = -1;
-	std::string command = "START_DIALOGUE|";
-	command.append(std::to_string(this->currentDialogueId));
-	for (size_t i = 0; i < list.lines.size(); i++) {
-		command.append("|");
-		command.append(list.lines[i]);
+void SpeechRecognitionClient::ClosePipe() {
+	std::lock_guard<std::mutex> lock(pipeLock);
+	writer.SetPipe(NULL);
+	delete pipe;
+	pipe = NULL;
+
+	OutboundWriter::Stats stats = writer.GetStats();
+	Log::info("Lines sent to the speech recognition service: " + std::to_string(stats.written) + ", max queue depth "
+		+ std::to_string(stats.maxDepth) + ", longest write " + std::to_string(stats.maxWriteTime) + " ms, "
+		+ std::to_string(stats.superseded) + " superseded before being sent");
+	Log::info("Repeated commands suppressed: " + std::to_string(dispatcher.GetSuppressedRepeats())
+		+ ", unregistered command ids: " + std::to_string(dispatcher.GetUnknownCommandIds())
+		+ ", Papyrus events dropped: " + std::to_string(dispatcher.GetDroppedPhraseEvents()));
+
+	for (int lane = 0; lane < kLane_Count; lane++) {
+		LaneStats laneStats = dispatcher.GetLaneStats((ResponseLane)lane);
+		if (laneStats.count > 0 || laneStats.expired > 0) {
+			Log::info("Response lane '" + std::string(ResponseDispatcher::LaneName((ResponseLane)lane)) + "': "
+				+ std::to_string(laneStats.count) + " handled, " + std::to_string(laneStats.expired) + " expired, average delay "
+				+ std::to_string(laneStats.count > 0 ? laneStats.totalDelay / laneStats.count : 0)
+				+ " ms, max " + std::to_string(laneStats.maxDelay) + " ms");
+		}
 	}
-	this->WriteLine(command);
+}
+
+void SpeechRecognitionClient::StopDialogue() {
+	WriteLine("STOP_DIALOGUE");
 }
 
 int SpeechRecognitionClient::ReadSelectedIndex() {
-	int t = this->selectedIndex;
-	this->selectedIndex = -1;
-	return t;
+	return dispatcher.ReadSelectedIndex();
 }
 
 std::string SpeechRecognitionClient::PopCommand() {
-	if (queuedCommands.empty())
-	{
-		return "";
+	return dispatcher.PopCommand();
+}
+
+void SpeechRecognitionClient::PopEquips(std::vector<EquipItem> &equips) {
+	dispatcher.PopEquips(equips);
+}
+
+void SpeechRecognitionClient::UpdatePhrases() {
+	phraseLines.clear();
+	phrases.TakePendingLines(phraseLines);
+	for (const std::string &line : phraseLines) {
+		WriteLine(line);
 	}
-	else
-	{
-		queueLock.lock();
-		std::string retcommand = queuedCommands.front();
-		queuedCommands.pop();
-		queueLock.unlock();
-
-		return retcommand;
+
+	recognizedPhrases.clear();
+	dispatcher.PopPhrases(recognizedPhrases);
+	if (!recognizedPhrases.empty()) {
+		phrases.Deliver(recognizedPhrases);
 	}
 }
 
-std::string SpeechRecognitionClient::PopEquip() {
-	if (queuedEquips.empty())
-	{
-		return "";
-	}
-	else
-	{
-		queueLock.lock();
-		std::string retcommand = queuedEquips.front();
-		queuedEquips.pop();
-		queueLock.unlock();
-
-		return retcommand;
+void SpeechRecognitionClient::PopPhraseEvents(std::vector<PhraseEvent> &batch) {
+	dispatcher.PopPhraseEvents(batch);
+}
+
+void SpeechRecognitionClient::MenuOpenClose(const char *menuName, bool opening) {
+	std::string line;
+	if (listenState.MenuOpenClose(menuName, opening, line)) {
+		WriteLine(line);
 	}
 }
 
-void SpeechRecognitionClient::EnqueueCommand(std::string command) {
-	// The custom command will be executed on the current thread,
-	// and the Skyrim command will be executed in the game thread.
-	if (ConsoleCommandRunner::TryRunCustomCommand(command)) {
+void SpeechRecognitionClient::UpdatePushToTalk() {
+	if (pushToTalkKey == 0) {
 		return;
 	}
-	queueLock.lock();
-	queuedCommands.push(command);
-	queueLock.unlock();
+	std::string line;
+	if (listenState.PushToTalk(keyState.IsKeyDown(pushToTalkKey), clientClock.NowMilliseconds(), line)) {
+		WriteLine(line);
+	}
 }
 
-void SpeechRecognitionClient::EnqueueEquip(std::string equip) {
-	queueLock.lock();
-	queuedEquips.push(equip);
-	queueLock.unlock();
+void SpeechRecognitionClient::EnqueueCommand(std::string command) {
+	dispatcher.EnqueueCommand(command);
 }
 
 void SpeechRecognitionClient::AwaitResponses() {
+	LineReader reader(*pipe, clientClock);
+	std::string inLine;
 
-	for (;;) {
-		std::string inLine = ReadLine();
-		std::vector<std::string> tokens = split(inLine, '|');
-		std::string responseType = tokens[0];
-		if (responseType == "DIALOGUE") {
-			int dialogueId = std::stoi(tokens[1]);
-			int indexId = std::stoi(tokens[2]);
-			if (dialogueId == this->currentDialogueId) {
-				this->selectedIndex = indexId;
-			}
-		}
-		else if (responseType == "COMMAND") {
-			std::vector<std::string> commands = split(tokens[1], ';');
-			for(int i = 0; i < commands.size(); i++)
-				this->EnqueueCommand(commands[i]);
-		}
-		else if (responseType == "EQUIP") {
-			this->EnqueueEquip(tokens[1]);
+	while (reader.ReadLine(inLine)) {
+		if (recorder) {
+			recorder->Record(kSessionLine_Inbound, inLine);
 		}
+		dispatcher.Dispatch(inLine);
 	}
-}
-
-std::string SpeechRecognitionClient::ReadLine() {
-	DWORD dwRead = 0;
-	char buffer[4096];
 
-	std::string line(workingLine);
-	for (;;) {
-		BOOL bSuccess = ReadFile(this->stdOutRd, buffer, 4096, &dwRead, NULL);
-		if (bSuccess && dwRead > 0)
-		{
-			std::string chunk = std::string(buffer, dwRead);
-			line = line.append(chunk);
-			for (size_t i = 0; i < chunk.length(); i++)
-			{
-				if (chunk[i] == '\n')
-				{
-					// Append any trailing line to the next readline call
-					if (i < chunk.length() - 1)
-						workingLine = chunk.substr(i + 1);
-					else
-						workingLine = "";
-
-					// Remove \n
-					line.pop_back();
-					return line;
-				}
-			}
-		}
-		Sleep(200);
-	}
-
-	return "";
+	Log::info("Speech recognition service closed the connection");
 }
 
-void SpeechRecognitionClient::WriteLine(std::string line) {
-	DWORD dwWritten;
-	line.push_back('\n');
-	WriteFile(this->stdInWr, line.c_str(), line.length(), &dwWritten, NULL);
+void SpeechRecognitionClient::WriteLine(std::string_view line) {
+	std::lock_guard<std::mutex> lock(pipeLock);
+	state.Remember(line);
+	// Dropped while the service is restarting, the state is restored when it is back
+	writer.Enqueue(line);
 }
 
-static DWORD WINAPI SpeechRecognitionClientThreadStart(void* ctx) {
-
-	extern std::string g_dllPath;
+// Launch the service with its stdin/stdout redirected to pipes. On success `stdInWr` and `stdOutRd` are the ends
+// of the pipes kept by the plugin, the others are closed so that reading fails once the service exits.
+static bool LaunchService(std::string commandLine, HANDLE &process, HANDLE &stdInWr, HANDLE &stdOutRd) {
+	HANDLE hChildStd_IN_Rd = NULL;
+	HANDLE hChildStd_OUT_Wr = NULL;
 
-	// Startup speech recognition service
 	SECURITY_ATTRIBUTES saAttr;
 	saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
 	saAttr.bInheritHandle = TRUE;
 	saAttr.lpSecurityDescriptor = NULL;
 
-	CreatePipe(&g_hChildStd_OUT_Rd, &g_hChildStd_OUT_Wr, &saAttr, 0);
-	SetHandleInformation(g_hChildStd_OUT_Rd, HANDLE_FLAG_INHERIT, 0);
-	CreatePipe(&g_hChildStd_IN_Rd, &g_hChildStd_IN_Wr, &saAttr, 0);
-	SetHandleInformation(g_hChildStd_IN_Wr, HANDLE_FLAG_INHERIT, 0);
-
-	std::string exePath = g_dllPath.substr(0, g_dllPath.find_last_of("\\/"))
-		.append("\\DragonbornSpeaksNaturally.exe")
-		.append(" --encoding UTF-8"); // Let the service set encoding of its stdin/stdout to UTF-8.
-                                    // This can avoid non-ASCII characters (such as Chinese characters) garbled.
-	
-	Log::info("Starting speech recognition service at ");
-	Log::info(exePath);
+	CreatePipe(&stdOutRd, &hChildStd_OUT_Wr, &saAttr, 0);
+	SetHandleInformation(stdOutRd, HANDLE_FLAG_INHERIT, 0);
+	CreatePipe(&hChildStd_IN_Rd, &stdInWr, &saAttr, 0);
+	SetHandleInformation(stdInWr, HANDLE_FLAG_INHERIT, 0);
 
-	LPSTR szCmdline = const_cast<char *>(exePath.c_str());
+	LPSTR szCmdline = const_cast<char *>(commandLine.c_str());
 	PROCESS_INFORMATION piProcInfo;
 	STARTUPINFO siStartInfo;
 	BOOL bSuccess = FALSE;
@@ -202,9 +195,9 @@ static DWORD WINAPI SpeechRecognitionClientThreadStart(void* ctx) {
 
 	ZeroMemory(&siStartInfo, sizeof(STARTUPINFO));
 	siStartInfo.cb = sizeof(STARTUPINFO);
-	//siStartInfo.hStdError = g_hChildStd_OUT_Wr;
-	siStartInfo.hStdOutput = g_hChildStd_OUT_Wr;
-	siStartInfo.hStdInput = g_hChildStd_IN_Rd;
+	//siStartInfo.hStdError = hChildStd_OUT_Wr;
+	siStartInfo.hStdOutput = hChildStd_OUT_Wr;
+	siStartInfo.hStdInput = hChildStd_IN_Rd;
 	siStartInfo.wShowWindow = SW_HIDE;
 	siStartInfo.dwFlags |= STARTF_USESTDHANDLES;
 	siStartInfo.dwFlags |= STARTF_USESHOWWINDOW;
@@ -220,18 +213,137 @@ static DWORD WINAPI SpeechRecognitionClientThreadStart(void* ctx) {
 		&siStartInfo,  // STARTUPINFO pointer 
 		&piProcInfo);  // receives PROCESS_INFORMATION 
 
-	CloseHandle(piProcInfo.hProcess);
+	// The service has its own copies of these
+	CloseHandle(hChildStd_IN_Rd);
+	CloseHandle(hChildStd_OUT_Wr);
+
+	if (!bSuccess) {
+		CloseHandle(stdInWr);
+		CloseHandle(stdOutRd);
+		return false;
+	}
+
 	CloseHandle(piProcInfo.hThread);
+	process = piProcInfo.hProcess;
+	return true;
+}
+
+// Wait for a service that closed the connection to exit and log its exit code
+static void ReapService(HANDLE process) {
+	const DWORD kExitTimeout = 5000;
 
-	if (bSuccess)
-	{
-		Log::info("Initialized speech recognition service");
-		SpeechRecognitionClient::getInstance()->SetHandles(g_hChildStd_IN_Wr, g_hChildStd_OUT_Rd);
-		SpeechRecognitionClient::getInstance()->AwaitResponses();
+	if (WaitForSingleObject(process, kExitTimeout) != WAIT_OBJECT_0) {
+		// It closed its stdout but kept running, do not leave it running next to its replacement
+		Log::info("Speech recognition service did not exit, terminating it");
+		TerminateProcess(process, 1);
 	}
-	else
-	{
-		Log::info("Failed to initialize speech recognition service");
+
+	DWORD exitCode = 0;
+	if (GetExitCodeProcess(process, &exitCode)) {
+		Log::info("Speech recognition service exited with code " + std::to_string(exitCode));
+	}
+	CloseHandle(process);
+}
+
+static DWORD WINAPI SpeechRecognitionClientThreadStart(void* ctx) {
+
+	extern std::string g_dllPath;
+
+	std::string exePath = g_dllPath.substr(0, g_dllPath.find_last_of("\\/"))
+		.append("\\DragonbornSpeaksNaturally.exe")
+		.append(" --encoding UTF-8"); // Let the service set encoding of its stdin/stdout to UTF-8.
+                                    // This can avoid non-ASCII characters (such as Chinese characters) garbled.
+
+	// A stand-in service (such as dsn_fake_service) can be launched instead, for end-to-end tests
+	std::string serviceCommandLine = PluginConfig::GetString("Debug", "serviceCommandLine");
+	if (!serviceCommandLine.empty()) {
+		exePath = serviceCommandLine;
+	}
+
+	// The shared memory transport is opt-in, the pipes are used when it cannot be set up
+	const uint32_t kAttachTimeout = 5000;
+	bool useSharedMemory = PluginConfig::GetString("SpeechRecognition", "transport", "pipe") == "sharedmemory";
+	uint32_t launches = 0;
+
+	SpeechRecognitionClient *client = SpeechRecognitionClient::getInstance();
+	RestartBackoff backoff;
+	uint64_t lostAt = 0;  // when the last running service was lost, 0 until then
+
+	// Supervise the service: launch it again whenever it exits
+	for (;;) {
+		Log::info("Starting speech recognition service at ");
+		Log::info(exePath);
+
+		uint64_t launchedAt = clientClock.NowMilliseconds();
+		uint64_t ranFor = 0;
+		HANDLE process = NULL;
+		HANDLE stdInWr = NULL;
+		HANDLE stdOutRd = NULL;
+
+		std::string commandLine = exePath;
+		WindowsSharedMemoryPipe *sharedMemory = NULL;
+		if (useSharedMemory) {
+			std::string name = "Local\\DragonbornSpeaksNaturally_" + std::to_string(GetCurrentProcessId()) + "_" + std::to_string(++launches);
+			sharedMemory = new WindowsSharedMemoryPipe();
+			if (sharedMemory->Create(name)) {
+				commandLine.append(" --shared-memory ").append(name);
+			}
+			else {
+				Log::info("Unable to create the shared memory region " + name + ", using pipes");
+				delete sharedMemory;
+				sharedMemory = NULL;
+			}
+		}
+
+		if (LaunchService(commandLine, process, stdInWr, stdOutRd))
+		{
+			Log::info("Initialized speech recognition service");
+
+			IPipe *servicePipe = NULL;
+			if (sharedMemory) {
+				sharedMemory->SetPeerCheck([process] { return WaitForSingleObject(process, 0) == WAIT_TIMEOUT; });
+				if (sharedMemory->WaitForService(kAttachTimeout)) {
+					Log::info("Connected to the speech recognition service through shared memory");
+					CloseHandle(stdInWr);
+					CloseHandle(stdOutRd);
+					servicePipe = sharedMemory;
+				}
+				else {
+					// It talks on stdin/stdout, e.g. an older service that does not know --shared-memory
+					Log::info("Speech recognition service did not open the shared memory region, using pipes from now on");
+					useSharedMemory = false;
+					delete sharedMemory;
+				}
+			}
+			if (!servicePipe) {
+				servicePipe = new WindowsPipe(stdInWr, stdOutRd);
+			}
+			client->Connect(servicePipe);
+			if (lostAt != 0) {
+				Log::info("Speech recognition service recovered " + std::to_string(clientClock.NowMilliseconds() - lostAt)
+					+ " ms after it was lost (restart " + std::to_string(backoff.Attempts()) + "), favorites and dialogue restored");
+			}
+
+			client->AwaitResponses();
+			// Terminated first if it is still running, so that a write blocked on its full stdin fails
+			ReapService(process);
+			client->ClosePipe();
+
+			lostAt = clientClock.NowMilliseconds();
+			ranFor = lostAt - launchedAt;
+		}
+		else
+		{
+			delete sharedMemory;
+			Log::info("Failed to initialize speech recognition service");
+			if (lostAt == 0) {
+				lostAt = clientClock.NowMilliseconds();
+			}
+		}
+
+		uint32_t delay = backoff.NextDelay(ranFor);
+		Log::info("Restarting speech recognition service in " + std::to_string(delay) + " ms");
+		clientClock.SleepMilliseconds(delay);
 	}
 
 	return 0;
@@ -1,17 +1,21 @@
 #pragma once
 #include "common/IPrefix.h"
 
+#include <mutex>
 #include <vector>
-#include <queue>
 #include <string>
 #include <windows.h> 
-#include <sstream>
-#include <mutex>
-
-struct DialogueList
-{
-	std::vector<std::string> lines;
-};
+#include <string_view>
+#include "DialogueArena.h"
+#include "EquipParser.h"
+#include "ListenState.h"
+#include "OutboundWriter.h"
+#include "PhraseRegistry.h"
+#include "ResponseDispatcher.h"
+#include "ServiceSupervision.h"
+#include "SessionRecording.h"
+#include "SpeechProtocol.h"
+#include "WindowsPlatform.h"
 
 class SpeechRecognitionClient
 {
@@ -20,32 +24,53 @@ public:
 
 	static void Initialize();
 	~SpeechRecognitionClient();
-	static SpeechRecognitionClient* instance;
-	void SetHandles(HANDLE h_stdInWr, HANDLE h_stdOutRd) {
-		stdInWr = h_stdInWr;
-		stdOutRd = h_stdOutRd;
-	}
+	// Connect to a newly launched service and restore the favorites and dialogue it lost.
+	// Takes ownership of the pipe (WindowsPipe or WindowsSharedMemoryPipe).
+	void Connect(IPipe *servicePipe);
+	// Disconnect from a service that exited, lines written until the next Connect only update the saved state
+	void ClosePipe();
 	void StopDialogue();
-	void StartDialogue(DialogueList list);
-	void WriteLine(std::string str);
+	// Send the topics of the dialogue menu, `getTopic(i)` returns the text of topic i.
+	// Called on the UI thread, the message is built in dialogueArena without per-topic allocations.
+	template<typename TopicGetter>
+	void StartDialogue(size_t topicCount, TopicGetter getTopic) {
+		WriteLine(BuildStartDialogue(dispatcher.StartDialogue(), topicCount, getTopic, dialogueArena));
+	}
+	// Queue a line for the service, the writer thread sends it
+	void WriteLine(std::string_view line);
 	int ReadSelectedIndex();
 	std::string PopCommand();
-	std::string PopEquip();
+	// Move all pending equip commands to the end of `equips`
+	void PopEquips(std::vector<EquipItem> &equips);
+	// Phrases of other plugins (see VoiceCommandApi.h)
+	PhraseRegistry &GetPhraseRegistry() { return phrases; }
+	// Called once per frame on the game thread: send the phrases registered since the last frame
+	// and run the callbacks of the recognized ones
+	void UpdatePhrases();
+	// Move the Papyrus events of the tagged phrases to `batch` (cleared first), see PapyrusPhraseEvents.h
+	void PopPhraseEvents(std::vector<PhraseEvent> &batch);
+	// Pause or resume the recognition of the service when a menu opens or closes (see ListenState.h)
+	void MenuOpenClose(const char *menuName, bool opening);
+	// Called once per frame on the game thread: pause or resume the recognition with the push-to-talk key
+	void UpdatePushToTalk();
+	// Dispatch the responses of the service until it closes the connection
 	void AwaitResponses();
 	void EnqueueCommand(std::string command);
 private:
-	HANDLE stdInWr;
-	HANDLE stdOutRd;
-	int selectedIndex = -1;
-	int currentDialogueId = 0;
-	std::mutex queueLock;
-	std::string workingLine;
-	void EnqueueEquip(std::string equip);
-	std::queue<std::string> queuedCommands;
-	std::queue<std::string> queuedEquips;
+	IPipe *pipe = NULL;
+	std::mutex pipeLock;  // guards pipe and state, WriteLine is called from the game threads
+	ServiceState state;
+	ResponseDispatcher dispatcher;
+	SessionRecorder *recorder = NULL;
+	OutboundWriter writer;
+	DialogueArena dialogueArena;
+	PhraseRegistry phrases;
+	std::vector<std::string> phraseLines;      // game thread only
+	std::vector<uint32_t> recognizedPhrases;  // game thread only
+	ListenState listenState;
+	WindowsKeyState keyState;
+	uint32_t pushToTalkKey = 0;
 
 	SpeechRecognitionClient();
-
-	std::string ReadLine();
 };
 
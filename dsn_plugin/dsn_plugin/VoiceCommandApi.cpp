@@ -0,0 +1,21 @@
+#include "VoiceCommandApi.h"
+#include "SpeechRecognitionClient.h"
+
+// Exported by name in exports.def, see VoiceCommandApi.h
+
+extern "C" {
+	uint32_t DSN_GetApiVersion(void) {
+		return DSN_API_VERSION;
+	}
+
+	uint32_t DSN_RegisterPhrase(const char *phrase, DSN_PhraseCallback callback, void *userData) {
+		if (!phrase) {
+			return 0;
+		}
+		return SpeechRecognitionClient::getInstance()->GetPhraseRegistry().Register(phrase, callback, userData);
+	}
+
+	int DSN_UnregisterPhrase(uint32_t phraseId) {
+		return SpeechRecognitionClient::getInstance()->GetPhraseRegistry().Unregister(phraseId) ? 1 : 0;
+	}
+};
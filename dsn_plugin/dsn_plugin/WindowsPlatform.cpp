@@ -0,0 +1,148 @@
+#include "WindowsPlatform.h"
+#include "KeyCode.hpp"
+#include "WindowUtils.hpp"
+
+uint64_t WindowsClock::NowMilliseconds() {
+	return GetTickCount64();
+}
+
+void WindowsClock::SleepMilliseconds(uint32_t milliseconds) {
+	Sleep(milliseconds);
+}
+
+void WindowsInputSink::KeyDown(uint32_t scanCode) {
+	SendKeyDown(scanCode);
+}
+
+void WindowsInputSink::KeyUp(uint32_t scanCode) {
+	SendKeyUp(scanCode);
+}
+
+bool WindowsKeyState::IsKeyDown(uint32_t scanCode) {
+	static const int MOUSE_BUTTON_VIRTUAL_KEYS[] = { VK_LBUTTON, VK_RBUTTON, VK_MBUTTON, VK_XBUTTON1, VK_XBUTTON2 };
+
+	UINT virtualKey;
+	if (scanCode >= KEY_SCAN_CODE_MOUSE_EVENT_BEGIN) {
+		uint32_t button = scanCode - KEY_SCAN_CODE_MOUSE_EVENT_BEGIN;
+		if (button >= sizeof(MOUSE_BUTTON_VIRTUAL_KEYS) / sizeof(MOUSE_BUTTON_VIRTUAL_KEYS[0])) {
+			return false;  // the mouse wheel has no state
+		}
+		virtualKey = MOUSE_BUTTON_VIRTUAL_KEYS[button];
+	}
+	else {
+		// DirectInput codes of the extended keys have the high bit set instead of the E0 prefix
+		UINT code = scanCode & 0x80 ? 0xE000 | (scanCode & 0x7F) : scanCode;
+		virtualKey = MapVirtualKey(code, MAPVK_VSC_TO_VK_EX);
+		if (virtualKey == 0) {
+			return false;
+		}
+	}
+	return (GetAsyncKeyState(virtualKey) & 0x8000) != 0;
+}
+
+WindowsPipe::WindowsPipe(HANDLE stdInWr, HANDLE stdOutRd) : stdInWr(stdInWr), stdOutRd(stdOutRd) {
+}
+
+WindowsPipe::~WindowsPipe() {
+	CloseHandle(stdInWr);
+	CloseHandle(stdOutRd);
+}
+
+int WindowsPipe::Read(char *buffer, size_t size) {
+	DWORD dwRead = 0;
+	if (!ReadFile(stdOutRd, buffer, (DWORD)size, &dwRead, NULL)) {
+		DWORD error = GetLastError();
+		return (error == ERROR_BROKEN_PIPE || error == ERROR_INVALID_HANDLE) ? -1 : 0;
+	}
+	return (int)dwRead;
+}
+
+bool WindowsPipe::Write(const char *data, size_t size) {
+	DWORD dwWritten = 0;
+	return WriteFile(stdInWr, data, (DWORD)size, &dwWritten, NULL) && dwWritten == size;
+}
+
+WindowsEventSignal::~WindowsEventSignal() {
+	if (event) {
+		CloseHandle(event);
+	}
+}
+
+bool WindowsEventSignal::Create(const std::string &name) {
+	event = CreateEventA(NULL, FALSE, FALSE, name.c_str());
+	return event != NULL;
+}
+
+void WindowsEventSignal::Wake(std::atomic<uint32_t> &) {
+	SetEvent(event);
+}
+
+void WindowsEventSignal::Wait(std::atomic<uint32_t> &sequence, uint32_t expected, uint32_t timeout) {
+	if (sequence.load() == expected) {
+		WaitForSingleObject(event, timeout);
+	}
+}
+
+WindowsSharedMemoryPipe::~WindowsSharedMemoryPipe() {
+	Close();
+	if (region) {
+		UnmapViewOfFile(region);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+}
+
+bool WindowsSharedMemoryPipe::Create(const std::string &name, uint32_t capacity) {
+	size_t size = RegionSize(capacity);
+	mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, name.c_str());
+	if (mapping == NULL || GetLastError() == ERROR_ALREADY_EXISTS) {
+		return false;
+	}
+	region = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (region == NULL) {
+		return false;
+	}
+
+	IRingSignal *ringSignals[kSignal_Count];
+	for (int i = 0; i < kSignal_Count; i++) {
+		if (!signals[i].Create(name + "." + std::to_string(i))) {
+			return false;
+		}
+		ringSignals[i] = &signals[i];
+	}
+
+	InitializeRegion(region, capacity, GetCurrentProcessId());
+	return Attach(region, size, ringSignals);
+}
+
+bool WindowsWindowLocator::ActivateWindow(const std::string &name) {
+	HWND window = NULL;
+	DWORD pid = 0;
+
+	if (name.empty()) {
+		pid = GetCurrentProcessId();
+	}
+	else {
+		pid = GetProcessIDByName(name.c_str());
+	}
+
+	if (pid != 0) {
+		window = FindMainWindow(pid);
+	}
+
+	if (window == NULL && !name.empty()) {
+		window = FindWindow(NULL, name.c_str());
+
+		if (window == NULL) {
+			window = FindWindow(name.c_str(), NULL);
+		}
+	}
+
+	if (window == NULL) {
+		return false;
+	}
+
+	SwitchToThisWindow(window, true);
+	return true;
+}
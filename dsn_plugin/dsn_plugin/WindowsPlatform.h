@@ -0,0 +1,84 @@
+#pragma once
+#include "Platform.h"
+#include "SharedMemoryPipe.h"
+#include <string>
+#include <Windows.h>
+
+// Windows implementations of the dsn_core platform interfaces (see Platform.h)
+
+class WindowsClock : public IClock
+{
+public:
+	uint64_t NowMilliseconds() override;
+	void SleepMilliseconds(uint32_t milliseconds) override;
+};
+
+// Simulated key presses with SendInput (see KeyCode.hpp)
+class WindowsInputSink : public IInputSink
+{
+public:
+	void KeyDown(uint32_t scanCode) override;
+	void KeyUp(uint32_t scanCode) override;
+};
+
+// Key state with GetAsyncKeyState
+class WindowsKeyState : public IKeyState
+{
+public:
+	bool IsKeyDown(uint32_t scanCode) override;
+};
+
+// Pair of anonymous pipes connected to the stdin/stdout of the speech recognition service.
+// Owns the handles, they are closed when the pipe is deleted.
+class WindowsPipe : public IPipe
+{
+public:
+	WindowsPipe(HANDLE stdInWr, HANDLE stdOutRd);
+	~WindowsPipe();
+
+	int Read(char *buffer, size_t size) override;
+	bool Write(const char *data, size_t size) override;
+
+private:
+	HANDLE stdInWr;
+	HANDLE stdOutRd;
+};
+
+// Named auto-reset event, the sequence word is not needed: a wake is kept until the waiter takes it
+class WindowsEventSignal : public IRingSignal
+{
+public:
+	WindowsEventSignal() : event(NULL) {}
+	~WindowsEventSignal();
+
+	bool Create(const std::string &name);
+
+	void Wake(std::atomic<uint32_t> &sequence) override;
+	void Wait(std::atomic<uint32_t> &sequence, uint32_t expected, uint32_t timeout) override;
+
+private:
+	HANDLE event;
+};
+
+// SharedMemoryPipe on a named file mapping backed by the paging file.
+// The events of the rings are named "<mapping name>.<SharedRingSignal>".
+class WindowsSharedMemoryPipe : public SharedMemoryPipe
+{
+public:
+	WindowsSharedMemoryPipe() : SharedMemoryPipe(kSide_Plugin), mapping(NULL), region(NULL) {}
+	~WindowsSharedMemoryPipe();
+
+	// Create the region `name` (e.g. "Local\\DragonbornSpeaksNaturally_<pid>") and its events
+	bool Create(const std::string &name, uint32_t capacity = kDefaultCapacity);
+
+private:
+	HANDLE mapping;
+	void *region;
+	WindowsEventSignal signals[kSignal_Count];
+};
+
+class WindowsWindowLocator : public IWindowLocator
+{
+public:
+	bool ActivateWindow(const std::string &name) override;
+};
@@ -0,0 +1,362 @@
+// dsn_fake_service: a stand-in for DragonbornSpeaksNaturally.exe that speaks the same stdin/stdout protocol
+// (see dsn_core/SpeechProtocol.h) without System.Speech or a microphone.
+//
+//   dsn_fake_service <script> [--log <file>] [--shared-memory <name>]
+//
+// --shared-memory (not on Windows) talks to the plugin over the shared memory region it created
+// (see dsn_core/SharedMemoryPipe.h) instead of stdin/stdout, like the real service.
+//
+// The script is run from top to bottom, one directive per line ('#' starts a comment):
+//
+//   expect <prefix>                       wait until a line starting with <prefix> is received
+//   send <line>                           send a line, e.g. "send COMMAND|tapkey r"
+//   dialogue <index>                      answer the last START_DIALOGUE: DIALOGUE|<its id>|<index>
+//   sleep <milliseconds>
+//   burst <count> <interval ms> <line>    send <line> <count> times, <interval ms> apart (0 = back to back)
+//   repeat <count>  ...  end              run the enclosed directives <count> times
+//   exit <code>                           exit immediately, like a crash of the service
+//
+// Every received line is checked like the real service would parse it. Problems are reported on stderr
+// (stdout is the protocol) and make the exit code 1. Like the real service, it exits when its stdin
+// (or the shared memory region) is closed, lines received after the end of the script are still checked.
+
+#include "SpeechProtocol.h"
+#ifndef _WIN32
+#include "PosixPlatform.h"
+#include <csignal>
+#endif
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Directive {
+	std::string name;
+	std::string argument;
+	int lineNumber;
+};
+
+static std::mutex receivedLock;
+static std::condition_variable receivedSignal;
+static std::deque<std::string> received;
+static bool inputClosed = false;
+static long long lastDialogueId = -1;
+static std::atomic<int> errorCount{ 0 };
+static FILE *logFile = NULL;
+static IPipe *sharedMemory = NULL;  // NULL: stdin/stdout
+
+static void reportError(const std::string &message, const std::string &line) {
+	errorCount++;
+	fprintf(stderr, "dsn_fake_service: %s: %s\n", message.c_str(), line.c_str());
+	if (logFile) {
+		fprintf(logFile, "ERROR %s: %s\n", message.c_str(), line.c_str());
+	}
+}
+
+static bool isInteger(const std::string &s) {
+	if (s.empty())
+		return false;
+	char *end = NULL;
+	strtoll(s.c_str(), &end, 10);
+	return *end == '\0';
+}
+
+static std::vector<std::string> split(const std::string &s, char delim) {
+	std::vector<std::string> tokens;
+	std::stringstream ss(s);
+	std::string item;
+	while (std::getline(ss, item, delim)) {
+		tokens.push_back(item);
+	}
+	if (!s.empty() && s.back() == delim) {
+		tokens.push_back("");
+	}
+	return tokens;
+}
+
+// Check a line from the plugin the way dsn_service parses it (SkyrimInterop.cs, DialogueList.cs, FavoritesList.cs)
+static void checkReceivedLine(const std::string &line) {
+	std::vector<std::string> tokens = split(line, '|');
+	const std::string &command = tokens.empty() ? line : tokens[0];
+
+	if (command == "START_DIALOGUE") {
+		if (tokens.size() < 2 || !isInteger(tokens[1])) {
+			reportError("START_DIALOGUE without a dialogue id", line);
+			return;
+		}
+		long long id = strtoll(tokens[1].c_str(), NULL, 10);
+		if (id <= lastDialogueId) {
+			reportError("START_DIALOGUE id is not increasing", line);
+		}
+		// START_DIALOGUE|<id>|<hash>|<line>|<hash>|<line>...
+		if (tokens.size() % 2 != 0) {
+			reportError("START_DIALOGUE line without a hash", line);
+		}
+		for (size_t i = 2; i + 1 < tokens.size(); i += 2) {
+			if (tokens[i].size() != 16 || tokens[i].find_first_not_of("0123456789abcdef") != std::string::npos) {
+				reportError("START_DIALOGUE with a malformed line hash", tokens[i]);
+			}
+		}
+		std::lock_guard<std::mutex> lock(receivedLock);
+		lastDialogueId = id;
+	}
+	else if (command == "STOP_DIALOGUE") {
+		if (tokens.size() != 1) {
+			reportError("STOP_DIALOGUE with arguments", line);
+		}
+	}
+	else if (command == "FAVORITES") {
+		// FAVORITES|<name>,<formId>,<itemId>,<isHanded>,<itemType>|...
+		for (size_t i = 1; i < tokens.size(); i++) {
+			std::vector<std::string> fields = split(tokens[i], ',');
+			if (fields.size() != 5) {
+				reportError("favorite without exactly 5 fields (a ',' or '|' in the name?)", tokens[i]);
+				continue;
+			}
+			if (!isInteger(fields[1]) || !isInteger(fields[2]) || !isInteger(fields[3]) || !isInteger(fields[4])) {
+				reportError("favorite with a malformed number", tokens[i]);
+				continue;
+			}
+			long long type = strtoll(fields[4].c_str(), NULL, 10);
+			if (type < 1 || type > 3) {
+				reportError("favorite with an unknown item type", tokens[i]);
+			}
+		}
+	}
+	else {
+		reportError("unknown message", line);
+	}
+}
+
+static bool readLine(std::string &line) {
+	if (sharedMemory) {
+		static SteadyClock clock;
+		static LineReader reader(*sharedMemory, clock);
+		return reader.ReadLine(line);
+	}
+	return (bool)std::getline(std::cin, line);
+}
+
+static void readInput() {
+	std::string line;
+	while (readLine(line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (logFile) {
+			fprintf(logFile, "< %s\n", line.c_str());
+			fflush(logFile);
+		}
+		checkReceivedLine(line);
+
+		std::lock_guard<std::mutex> lock(receivedLock);
+		received.push_back(line);
+		receivedSignal.notify_all();
+	}
+
+	std::lock_guard<std::mutex> lock(receivedLock);
+	inputClosed = true;
+	receivedSignal.notify_all();
+}
+
+static void send(const std::string &line) {
+	// The real service writes and flushes one line at a time
+	if (sharedMemory) {
+		std::string message = line + "\n";
+		sharedMemory->Write(message.data(), message.size());
+	}
+	else {
+		fwrite(line.data(), 1, line.size(), stdout);
+		fputc('\n', stdout);
+		fflush(stdout);
+	}
+	if (logFile) {
+		fprintf(logFile, "> %s\n", line.c_str());
+	}
+}
+
+// Returns false when stdin was closed before a matching line arrived
+static bool expect(const std::string &prefix) {
+	std::unique_lock<std::mutex> lock(receivedLock);
+	for (;;) {
+		while (!received.empty()) {
+			std::string line = received.front();
+			received.pop_front();
+			if (line.compare(0, prefix.size(), prefix) == 0) {
+				return true;
+			}
+		}
+		if (inputClosed) {
+			return false;
+		}
+		receivedSignal.wait(lock);
+	}
+}
+
+static bool loadScript(const char *path, std::vector<Directive> &script) {
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		size_t start = line.find_first_not_of(" \t");
+		if (start == std::string::npos || line[start] == '#') {
+			continue;
+		}
+		size_t nameEnd = line.find_first_of(" \t", start);
+		Directive directive;
+		directive.name = line.substr(start, nameEnd - start);
+		if (nameEnd != std::string::npos) {
+			size_t argumentStart = line.find_first_not_of(" \t", nameEnd);
+			if (argumentStart != std::string::npos) {
+				directive.argument = line.substr(argumentStart);
+			}
+		}
+		directive.lineNumber = lineNumber;
+		script.push_back(directive);
+	}
+	return true;
+}
+
+// Run script[begin, end), returns false when the script must stop
+static bool run(const std::vector<Directive> &script, size_t begin, size_t end) {
+	for (size_t i = begin; i < end; i++) {
+		const Directive &directive = script[i];
+
+		if (directive.name == "expect") {
+			if (!expect(directive.argument)) {
+				return false;
+			}
+		}
+		else if (directive.name == "send") {
+			send(directive.argument);
+		}
+		else if (directive.name == "dialogue") {
+			long long id;
+			{
+				std::lock_guard<std::mutex> lock(receivedLock);
+				id = lastDialogueId;
+			}
+			send("DIALOGUE|" + std::to_string(id) + "|" + directive.argument);
+		}
+		else if (directive.name == "sleep") {
+			std::this_thread::sleep_for(std::chrono::milliseconds(atoi(directive.argument.c_str())));
+		}
+		else if (directive.name == "burst") {
+			std::istringstream args(directive.argument);
+			int count = 0;
+			int interval = 0;
+			args >> count >> interval;
+			std::string line;
+			std::getline(args >> std::ws, line);
+			for (int n = 0; n < count; n++) {
+				if (n > 0 && interval > 0) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+				}
+				send(line);
+			}
+		}
+		else if (directive.name == "repeat") {
+			// Find the matching end
+			size_t blockEnd = i + 1;
+			for (int depth = 1; blockEnd < end; blockEnd++) {
+				if (script[blockEnd].name == "repeat")
+					depth++;
+				else if (script[blockEnd].name == "end" && --depth == 0)
+					break;
+			}
+			int count = atoi(directive.argument.c_str());
+			for (int n = 0; n < count; n++) {
+				if (!run(script, i + 1, blockEnd)) {
+					return false;
+				}
+			}
+			i = blockEnd;
+		}
+		else if (directive.name == "exit") {
+			if (logFile) {
+				fprintf(logFile, "EXIT %s\n", directive.argument.c_str());
+				fclose(logFile);
+			}
+			fflush(stdout);
+			_Exit(atoi(directive.argument.c_str()));
+		}
+		else if (directive.name != "end") {
+			fprintf(stderr, "dsn_fake_service: unknown directive '%s' at line %d\n", directive.name.c_str(), directive.lineNumber);
+			errorCount++;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	const char *scriptPath = NULL;
+	const char *sharedMemoryName = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+			logFile = fopen(argv[++i], "w");
+		}
+		else if (strcmp(argv[i], "--shared-memory") == 0 && i + 1 < argc) {
+			sharedMemoryName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--encoding") == 0 && i + 1 < argc) {
+			// Accepted for compatibility with the command line of the real service, always UTF-8
+			i++;
+		}
+		else if (!scriptPath) {
+			scriptPath = argv[i];
+		}
+	}
+
+	std::vector<Directive> script;
+	if (!scriptPath || !loadScript(scriptPath, script)) {
+		fprintf(stderr, "Usage: dsn_fake_service <script> [--log <file>] [--shared-memory <name>]\n");
+		return 2;
+	}
+
+#ifndef _WIN32
+	PosixSharedMemoryPipe sharedMemoryPipe(SharedMemoryPipe::kSide_Service);
+	if (sharedMemoryName) {
+		if (!sharedMemoryPipe.Open(sharedMemoryName)) {
+			fprintf(stderr, "dsn_fake_service: cannot open the shared memory region %s\n", sharedMemoryName);
+			return 2;
+		}
+		pid_t plugin = (pid_t)sharedMemoryPipe.GetPluginProcessId();
+		sharedMemoryPipe.SetPeerCheck([plugin] { return kill(plugin, 0) == 0; });
+		sharedMemory = &sharedMemoryPipe;
+	}
+#else
+	if (sharedMemoryName) {
+		fprintf(stderr, "dsn_fake_service: --shared-memory is not supported on Windows\n");
+		return 2;
+	}
+#endif
+
+	std::thread reader(readInput);
+	run(script, 0, script.size());
+	reader.join();
+#ifndef _WIN32
+	sharedMemoryPipe.Close();
+#endif
+
+	if (logFile) {
+		fclose(logFile);
+	}
+	return errorCount > 0 ? 1 : 0;
+}
@@ -0,0 +1,35 @@
+// Driver for compilers without libFuzzer (GCC, MSVC).
+// Runs LLVMFuzzerTestOneInput once for every file given on the command line,
+// or once for stdin if there are no arguments. Useful to replay a corpus or a crash.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static void runInput(std::istream &in) {
+	std::vector<char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size());
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		runInput(std::cin);
+		return 0;
+	}
+
+	for (int i = 1; i < argc; i++) {
+		std::ifstream file(argv[i], std::ios::binary);
+		if (!file) {
+			fprintf(stderr, "Cannot open %s\n", argv[i]);
+			return 1;
+		}
+		runInput(file);
+		printf("Executed %s\n", argv[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,389 @@
+// dsn_replay: replay a session recorded by the plugin ([Debug] recordSessionFile in DragonbornSpeaksNaturally.ini)
+// through the protocol and dispatch code of dsn_core, without the game and the speech recognition service.
+//
+//   dsn_replay <recording> [--speed <factor>] [--frame-ms <milliseconds>] [--repeat-window <milliseconds>]
+//              [--service <command line> [--shared-memory]]
+//
+// --speed 1 replays at the recorded speed, 10 ten times faster, 0 as fast as possible.
+// --frame-ms is the interval at which the simulated game thread takes commands (default 16, ~60 FPS).
+// --repeat-window is [SpeechRecognition] commandRepeatWindow of the plugin (see CommandDebouncer.h), 0 to disable.
+// --service (not on Windows) starts a speech recognition service, usually dsn_fake_service with a script,
+//           and talks to it over POSIX pipes: the recorded outbound lines are sent to it through an OutboundWriter
+//           and its responses are dispatched instead of the recorded inbound lines. Used for load and latency tests.
+// --shared-memory talks to the --service process over a shared memory region (see SharedMemoryPipe.h)
+//           instead of its stdin/stdout.
+//
+// Three threads run like in the game:
+//  - the service: writes the recorded inbound lines to a pipe at their recorded time
+//    (or sends the recorded outbound lines to the --service process),
+//  - the reader: reads the pipe and dispatches the lines, the dispatcher's command lane runs the custom commands
+//    (sleeps are scaled by the speed),
+//  - the game thread: every frame takes one console command, all equips, the recognized phrases
+//    of other plugins, the Papyrus events and the selected dialogue topic.
+// Queueing delay is the time a console command or a dialogue selection waited for the game thread,
+// with the millisecond resolution of the dispatcher's timestamps.
+
+#include "ResponseDispatcher.h"
+#include "CustomCommands.h"
+#include "OutboundWriter.h"
+#include "SessionRecording.h"
+#include "SpeechProtocol.h"
+#ifndef _WIN32
+#include "PosixPlatform.h"
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock ReplayTime;
+
+// Microsecond clock, custom command sleeps are divided by the replay speed
+class ReplayClock : public IClock
+{
+public:
+	explicit ReplayClock(double speed) : speed(speed), start(ReplayTime::now()) {}
+
+	uint64_t NowMilliseconds() override {
+		return NowMicroseconds() / 1000;
+	}
+	uint64_t NowMicroseconds() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(ReplayTime::now() - start).count();
+	}
+	void SleepMilliseconds(uint32_t milliseconds) override {
+		if (speed > 0) {
+			std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(milliseconds * 1000 / speed)));
+		}
+	}
+
+private:
+	double speed;
+	ReplayTime::time_point start;
+};
+
+class CountingInputSink : public IInputSink
+{
+public:
+	std::atomic<uint64_t> keyEvents{ 0 };
+
+	void KeyDown(uint32_t) override { keyEvents++; }
+	void KeyUp(uint32_t) override { keyEvents++; }
+};
+
+class NullWindowLocator : public IWindowLocator
+{
+public:
+	bool ActivateWindow(const std::string &) override { return true; }
+};
+
+// Blocking in-memory pipe, like the anonymous pipe of the service's stdout
+class ReplayPipe : public IPipe
+{
+public:
+	void Push(const std::string &line) {
+		std::lock_guard<std::mutex> lock(mutex);
+		data.append(line);
+		data.push_back('\n');
+		available.notify_one();
+	}
+
+	void Close() {
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		available.notify_one();
+	}
+
+	int Read(char *buffer, size_t size) override {
+		std::unique_lock<std::mutex> lock(mutex);
+		available.wait(lock, [this] { return position < data.size() || closed; });
+		if (position >= data.size()) {
+			return -1;
+		}
+		size_t count = std::min(size, data.size() - position);
+		memcpy(buffer, data.data() + position, count);
+		position += count;
+		return (int)count;
+	}
+
+	bool Write(const char *, size_t) override { return true; }
+
+private:
+	std::mutex mutex;
+	std::condition_variable available;
+	std::string data;
+	size_t position = 0;
+	bool closed = false;
+};
+
+struct DelayStats {
+	std::vector<uint64_t> delays; // microseconds
+
+	void Print(const char *name) {
+		if (delays.empty()) {
+			printf("  %-22s none\n", name);
+			return;
+		}
+		std::sort(delays.begin(), delays.end());
+		uint64_t total = 0;
+		for (uint64_t delay : delays) {
+			total += delay;
+		}
+		printf("  %-22s n=%zu  avg=%.2f ms  p50=%.2f ms  p95=%.2f ms  max=%.2f ms\n", name, delays.size(),
+			total / 1000.0 / delays.size(),
+			delays[delays.size() / 2] / 1000.0,
+			delays[std::min(delays.size() - 1, delays.size() * 95 / 100)] / 1000.0,
+			delays.back() / 1000.0);
+	}
+};
+
+static void usage() {
+	fprintf(stderr, "Usage: dsn_replay <recording> [--speed <factor>] [--frame-ms <milliseconds>] [--repeat-window <milliseconds>]\n"
+		"                  [--service <command line> [--shared-memory]]\n");
+}
+
+int main(int argc, char **argv) {
+	const char *path = NULL;
+	double speed = 1;
+	int frameMs = 16;
+	int repeatWindow = CommandDebouncer::kDefaultWindow;
+	const char *serviceCommandLine = NULL;
+	bool useSharedMemory = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+			speed = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--frame-ms") == 0 && i + 1 < argc) {
+			frameMs = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--repeat-window") == 0 && i + 1 < argc) {
+			repeatWindow = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--service") == 0 && i + 1 < argc) {
+			serviceCommandLine = argv[++i];
+		}
+		else if (strcmp(argv[i], "--shared-memory") == 0) {
+			useSharedMemory = true;
+		}
+		else if (!path && argv[i][0] != '-') {
+			path = argv[i];
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (!path) {
+		usage();
+		return 2;
+	}
+
+	std::vector<SessionLine> session;
+	if (!ReadSessionRecording(path, session)) {
+		fprintf(stderr, "Cannot read session recording %s\n", path);
+		return 1;
+	}
+
+	ReplayClock clock(speed);
+	CountingInputSink input;
+	NullWindowLocator windows;
+	CustomCommandRunner customCommands(clock, input, windows);
+	std::atomic<uint64_t> customCommandCount{ 0 };
+	ResponseDispatcher dispatcher(clock, [&](const ParsedCommand &command) {
+		if (customCommands.Run(command)) {
+			customCommandCount++;
+			return true;
+		}
+		return false;
+	});
+	dispatcher.SetRepeatWindow(repeatWindow);
+
+	ReplayPipe replayPipe;
+	IPipe *pipe = &replayPipe;
+	OutboundWriter writer(clock);
+#ifndef _WIN32
+	PosixProcessPipe servicePipe;
+	PosixSharedMemoryPipe sharedMemoryPipe(SharedMemoryPipe::kSide_Plugin);
+	if (serviceCommandLine) {
+		std::string commandLine = serviceCommandLine;
+		if (useSharedMemory) {
+			std::string name = "/dsn_replay_" + std::to_string(getpid());
+			if (!sharedMemoryPipe.Create(name)) {
+				fprintf(stderr, "Cannot create the shared memory region %s\n", name.c_str());
+				return 1;
+			}
+			commandLine += " --shared-memory " + name;
+		}
+		if (!servicePipe.Start(commandLine)) {
+			fprintf(stderr, "Cannot start %s\n", serviceCommandLine);
+			return 1;
+		}
+		pipe = &servicePipe;
+		if (useSharedMemory) {
+			sharedMemoryPipe.SetPeerCheck([&servicePipe] { return servicePipe.IsRunning(); });
+			if (!sharedMemoryPipe.WaitForService(5000)) {
+				fprintf(stderr, "%s did not open the shared memory region\n", serviceCommandLine);
+				return 1;
+			}
+			pipe = &sharedMemoryPipe;
+		}
+		writer.SetPipe(pipe);
+	}
+#else
+	if (serviceCommandLine) {
+		fprintf(stderr, "--service is not supported on Windows\n");
+		return 2;
+	}
+#endif
+	int serviceExitCode = 0;
+	std::atomic<bool> serviceDone{ false };
+	std::atomic<bool> readerDone{ false };
+	std::atomic<int> dialoguesToStart{ 0 };
+
+	// The service side: inbound lines at their recorded time. START_DIALOGUE lines are handed to the game thread,
+	// so the dialogue ids of the recorded DIALOGUE responses match.
+	std::thread service([&] {
+		for (const SessionLine &entry : session) {
+			if (speed > 0) {
+				uint64_t due = (uint64_t)(entry.time * 1000 / speed);
+				uint64_t now = clock.NowMicroseconds();
+				if (due > now) {
+					std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+				}
+			}
+			if (entry.direction == kSessionLine_Inbound) {
+				if (!serviceCommandLine) {
+					replayPipe.Push(entry.line);
+				}
+				continue;
+			}
+			if (entry.line.compare(0, 15, "START_DIALOGUE|") == 0) {
+				dialoguesToStart++;
+			}
+			if (serviceCommandLine) {
+				writer.Enqueue(entry.line);
+			}
+		}
+#ifndef _WIN32
+		if (serviceCommandLine) {
+			writer.Flush();
+			writer.SetPipe(nullptr);
+			sharedMemoryPipe.Close();
+			// Closing its stdin makes the service exit, then the reader gets the end of its output
+			serviceExitCode = servicePipe.Stop();
+		}
+#endif
+		replayPipe.Close();
+		serviceDone = true;
+	});
+
+	// The reader thread of SpeechRecognitionClient::AwaitResponses()
+	uint64_t dispatchTime = 0;
+	uint64_t dispatchedLines = 0;
+	std::thread reader([&] {
+		LineReader lineReader(*pipe, clock);
+		std::string line;
+		while (lineReader.ReadLine(line)) {
+			uint64_t start = clock.NowMicroseconds();
+			dispatcher.Dispatch(line);
+			dispatchTime += clock.NowMicroseconds() - start;
+			dispatchedLines++;
+		}
+		dispatcher.FlushCommands();
+		readerDone = true;
+	});
+
+	// The game thread: runCommand() / ProcessEquipCommands() once per frame
+	DelayStats commandDelays;
+	DelayStats dialogueDelays;
+	uint64_t frames = 0;
+	std::vector<EquipItem> equips;
+	uint64_t equipCount = 0;
+	std::vector<uint32_t> phrases;
+	uint64_t phraseCount = 0;
+	std::vector<PhraseEvent> phraseEvents;
+	uint64_t phraseEventCount = 0;
+	for (;;) {
+		bool done = readerDone;
+		uint64_t now = clock.NowMilliseconds();
+
+		while (dialoguesToStart > 0) {
+			dialoguesToStart--;
+			dispatcher.StartDialogue();
+		}
+
+		uint64_t selectedAt = 0;
+		if (dispatcher.ReadSelectedIndex(&selectedAt) >= 0) {
+			dialogueDelays.delays.push_back((now - selectedAt) * 1000);
+		}
+
+		uint64_t queuedAt = 0;
+		std::string command = dispatcher.PopCommand(&queuedAt);
+		if (!command.empty()) {
+			commandDelays.delays.push_back((now - queuedAt) * 1000);
+		}
+
+		equips.clear();
+		dispatcher.PopEquips(equips);
+		equipCount += equips.size();
+
+		phrases.clear();
+		dispatcher.PopPhrases(phrases);
+		phraseCount += phrases.size();
+
+		phraseEvents.clear();
+		dispatcher.PopPhraseEvents(phraseEvents);
+		phraseEventCount += phraseEvents.size();
+
+		frames++;
+		if (done && command.empty() && equips.empty() && phrases.empty() && phraseEvents.empty()) {
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(frameMs));
+	}
+
+	service.join();
+	reader.join();
+
+	uint64_t wallTime = clock.NowMicroseconds();
+	printf("Replayed %s: %zu lines at speed %g, %d ms frames\n", path, session.size(), speed, frameMs);
+	printf("  wall time              %.1f ms, %llu frames\n", wallTime / 1000.0, (unsigned long long)frames);
+	printf("  dispatched lines       %llu, %llu custom commands, %llu simulated key events\n",
+		(unsigned long long)dispatchedLines, (unsigned long long)customCommandCount.load(), (unsigned long long)input.keyEvents.load());
+	printf("  equips                 %llu\n", (unsigned long long)equipCount);
+	printf("  registered phrases     %llu recognized\n", (unsigned long long)phraseCount);
+	printf("  Papyrus events         %llu, %llu dropped\n", (unsigned long long)phraseEventCount, (unsigned long long)dispatcher.GetDroppedPhraseEvents());
+	printf("  suppressed repeats     %llu\n", (unsigned long long)dispatcher.GetSuppressedRepeats());
+	printf("  unknown command ids    %llu\n", (unsigned long long)dispatcher.GetUnknownCommandIds());
+	printf("  dispatch time          %.2f ms total, %.0f lines/s\n", dispatchTime / 1000.0,
+		dispatchTime > 0 ? dispatchedLines * 1e6 / dispatchTime : 0.0);
+	printf("Queueing delay (received -> taken by the game thread):\n");
+	commandDelays.Print("console commands");
+	dialogueDelays.Print("dialogue selections");
+	printf("Response lanes (received -> handled, custom commands included):\n");
+	for (int lane = 0; lane < kLane_Count; lane++) {
+		LaneStats stats = dispatcher.GetLaneStats((ResponseLane)lane);
+		printf("  %-22s n=%llu  avg=%.2f ms  max=%llu ms  expired=%llu\n", ResponseDispatcher::LaneName((ResponseLane)lane),
+			(unsigned long long)stats.count, stats.count > 0 ? (double)stats.totalDelay / stats.count : 0.0,
+			(unsigned long long)stats.maxDelay, (unsigned long long)stats.expired);
+	}
+
+	if (serviceCommandLine) {
+		OutboundWriter::Stats stats = writer.GetStats();
+		printf("Outbound writer (%s):\n", useSharedMemory ? "shared memory" : "pipes");
+		printf("  lines written          %llu, max queue depth %zu, longest write %llu ms\n",
+			(unsigned long long)stats.written, stats.maxDepth, (unsigned long long)stats.maxWriteTime);
+		printf("  superseded lines       %llu\n", (unsigned long long)stats.superseded);
+		printf("Service exited with code %d\n", serviceExitCode);
+		return serviceExitCode == 0 ? 0 : 1;
+	}
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include "CommandDebouncer.h"
+#include "TestPlatform.h"
+#include "TestHarness.h"
+
+TEST(CommandDebouncer, DropsRepeatsWithinTheWindow) {
+	TestClock clock;
+	CommandDebouncer debouncer(clock, 400);
+
+	EXPECT_FALSE(debouncer.IsRepeat("COMMAND|tapkey r|1500|10"));
+	clock.now += 100;
+	// The deadline and the age are not part of the key
+	EXPECT_TRUE(debouncer.IsRepeat("COMMAND|tapkey r|1500|40"));
+	EXPECT_FALSE(debouncer.IsRepeat("COMMAND|tapkey e"));
+	EXPECT_EQ(1u, debouncer.Suppressed());
+
+	// The window counts from the first report, repeats do not extend it
+	clock.now += 300;
+	EXPECT_FALSE(debouncer.IsRepeat("COMMAND|tapkey r"));
+	EXPECT_EQ(1u, debouncer.Suppressed());
+}
+
+TEST(CommandDebouncer, KeysByTypeAndId) {
+	TestClock clock;
+	CommandDebouncer debouncer(clock);
+
+	EXPECT_FALSE(debouncer.IsRepeat("COMMAND_ID|3"));
+	EXPECT_TRUE(debouncer.IsRepeat("COMMAND_ID|3|1500|0"));
+	EXPECT_FALSE(debouncer.IsRepeat("COMMAND|3"));
+	EXPECT_FALSE(debouncer.IsRepeat("PHRASE|3"));
+	EXPECT_TRUE(debouncer.IsRepeat("PHRASE|3"));
+	EXPECT_FALSE(debouncer.IsRepeat("PAPYRUS_EVENT|3|0.91|open the door"));
+	EXPECT_TRUE(debouncer.IsRepeat("PAPYRUS_EVENT|3|0.85|open the door"));
+	EXPECT_EQ(3u, debouncer.Suppressed());
+}
+
+TEST(CommandDebouncer, IgnoresOtherLines) {
+	TestClock clock;
+	CommandDebouncer debouncer(clock);
+
+	EXPECT_FALSE(debouncer.IsRepeat("DIALOGUE|1|0"));
+	EXPECT_FALSE(debouncer.IsRepeat("DIALOGUE|1|0"));
+	EXPECT_FALSE(debouncer.IsRepeat("EQUIP|77495;1;1;1"));
+	EXPECT_FALSE(debouncer.IsRepeat("EQUIP|77495;1;1;1"));
+	EXPECT_EQ(0u, debouncer.Suppressed());
+}
+
+TEST(CommandDebouncer, DisabledWithAZeroWindow) {
+	TestClock clock;
+	CommandDebouncer debouncer(clock);
+	debouncer.SetWindow(0);
+
+	EXPECT_FALSE(debouncer.IsRepeat("COMMAND|tapkey r"));
+	EXPECT_FALSE(debouncer.IsRepeat("COMMAND|tapkey r"));
+	EXPECT_EQ(0u, debouncer.Suppressed());
+}
@@ -0,0 +1,65 @@
+#include "CommandTable.h"
+#include "TestHarness.h"
+#include <string>
+#include <vector>
+
+static std::vector<std::string> texts(const std::vector<ParsedCommandPtr> *commands) {
+	std::vector<std::string> result;
+	for (const ParsedCommandPtr &command : *commands) {
+		result.push_back(command->text);
+	}
+	return result;
+}
+
+TEST(CommandTable, Register) {
+	CommandTable table;
+	EXPECT_EQ(2u, table.Register("0|tapkey r;sleep 10|3|player.additem f 1"));
+	EXPECT_EQ(2u, table.Size());
+
+	const std::vector<ParsedCommandPtr> *commands = table.Find(0);
+	ASSERT_TRUE(commands != nullptr);
+	EXPECT_EQ((std::vector<std::string>{ "tapkey r", "sleep 10" }), texts(commands));
+	ASSERT_TRUE(table.Find(3) != nullptr);
+	EXPECT_EQ((std::vector<std::string>{ "player.additem f 1" }), texts(table.Find(3)));
+
+	EXPECT_TRUE(table.Find(1) == nullptr);
+	EXPECT_TRUE(table.Find(4) == nullptr);
+	EXPECT_TRUE(table.Find(-1) == nullptr);
+}
+
+TEST(CommandTable, ParsesAtRegistration) {
+	CommandTable table;
+	table.Register("0|press ctrl 500 a 400;player.cast 0003f9ed player voice");
+
+	const std::vector<ParsedCommandPtr> &commands = *table.Find(0);
+	ASSERT_EQ(2u, commands.size());
+	EXPECT_TRUE(commands[0]->IsCustom());
+	EXPECT_EQ((std::vector<std::string>{ "press", "ctrl", "500", "a", "400" }), commands[0]->params);
+	EXPECT_FALSE(commands[1]->IsCustom());
+}
+
+TEST(CommandTable, SkipsMalformedEntries) {
+	CommandTable table;
+	EXPECT_EQ(2u, table.Register("x|tapkey a|1|;;|2|tapkey b|-1|tapkey c|65536|tapkey d|7|tapkey e|8"));
+	EXPECT_TRUE(table.Find(1) == nullptr);
+	EXPECT_TRUE(table.Find(2) != nullptr);
+	EXPECT_TRUE(table.Find(7) != nullptr);
+	EXPECT_TRUE(table.Find(8) == nullptr);
+	EXPECT_TRUE(table.Find(65536) == nullptr);
+
+	// The last entry of a duplicated id wins
+	EXPECT_EQ(1u, table.Register("5|tapkey a|5|tapkey b"));
+	EXPECT_EQ((std::vector<std::string>{ "tapkey b" }), texts(table.Find(5)));
+}
+
+TEST(CommandTable, RegisterReplacesTheTable) {
+	CommandTable table;
+	table.Register("0|tapkey r|1|tapkey e");
+	ParsedCommandPtr queued = (*table.Find(1))[0];
+
+	EXPECT_EQ(1u, table.Register("0|tapkey q"));
+	EXPECT_TRUE(table.Find(1) == nullptr);
+	EXPECT_EQ((std::vector<std::string>{ "tapkey q" }), texts(table.Find(0)));
+	// Commands taken from the old table stay valid
+	EXPECT_EQ("tapkey e", queued->text);
+}
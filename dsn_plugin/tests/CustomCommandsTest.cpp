@@ -0,0 +1,92 @@
+#include "CustomCommands.h"
+#include "KeyScanCode.h"
+#include "TestPlatform.h"
+#include "TestHarness.h"
+#include <string>
+#include <vector>
+
+TEST(GetKeyScanCode, NamesAndCodes) {
+	EXPECT_EQ(19u, GetKeyScanCode("r"));
+	EXPECT_EQ(42u, GetKeyScanCode("Shift"));
+	EXPECT_EQ(256u, GetKeyScanCode("LeftMouseButton"));
+	EXPECT_EQ(0x2Cu, GetKeyScanCode("0x2C"));
+	EXPECT_EQ(44u, GetKeyScanCode("44"));
+	EXPECT_EQ(0u, GetKeyScanCode("unknownkey"));
+}
+
+TEST(BuildPressSchedule, ReleasesInTimeOrder) {
+	std::vector<uint32_t> keyDown;
+	KeyReleaseSchedule keyUp;
+	BuildPressSchedule({ "press", "ctrl", "500", "alt", "500", "a", "400" }, keyDown, keyUp);
+
+	EXPECT_EQ((std::vector<uint32_t>{ 29, 56, 30 }), keyDown);
+	// Keys released at the same time are moved 1 ms apart
+	EXPECT_EQ((KeyReleaseSchedule{ { 400, 30 }, { 500, 29 }, { 501, 56 } }), keyUp);
+}
+
+TEST(BuildPressSchedule, DefaultTimeAndUnknownKeys) {
+	std::vector<uint32_t> keyDown;
+	KeyReleaseSchedule keyUp;
+	BuildPressSchedule({ "press", "m" }, keyDown, keyUp);
+	EXPECT_EQ((KeyReleaseSchedule{ { CustomCommandRunner::kDefaultKeyPressTime, 50 } }), keyUp);
+
+	keyDown.clear();
+	keyUp.clear();
+	BuildPressSchedule({ "press", "unknownkey", "100", "m", "0" }, keyDown, keyUp);
+	EXPECT_TRUE(keyDown.empty());
+	EXPECT_TRUE(keyUp.empty());
+}
+
+TEST(CustomCommandRunner, Parse) {
+	ParsedCommand command = CustomCommandRunner::Parse("TapKey  ctrl a");
+	EXPECT_TRUE(command.IsCustom());
+	EXPECT_EQ("TapKey  ctrl a", command.text);
+	EXPECT_EQ((std::vector<std::string>{ "TapKey", "ctrl", "a" }), command.params);
+
+	command = CustomCommandRunner::Parse("player.additem f 100");
+	EXPECT_FALSE(command.IsCustom());
+	EXPECT_EQ("player.additem f 100", command.text);
+	EXPECT_TRUE(command.params.empty());
+
+	EXPECT_FALSE(CustomCommandRunner::Parse("").IsCustom());
+}
+
+TEST(CustomCommandRunner, RunsKeyCommands) {
+	TestClock clock;
+	RecordingInputSink input;
+	RecordingWindowLocator windows;
+	CustomCommandRunner runner(clock, input, windows);
+
+	EXPECT_TRUE(runner.TryRun("holdkey shift"));
+	EXPECT_TRUE(runner.Run(CustomCommandRunner::Parse("tapkey r")));
+	EXPECT_TRUE(runner.TryRun("releasekey shift"));
+	EXPECT_EQ((std::vector<std::string>{ "+42", "+19", "-19", "-42" }), input.Events());
+	EXPECT_EQ(1000u + CustomCommandRunner::kDefaultKeyPressTime, clock.now);
+}
+
+TEST(CustomCommandRunner, SleepAndSwitchWindow) {
+	TestClock clock;
+	RecordingInputSink input;
+	RecordingWindowLocator windows;
+	CustomCommandRunner runner(clock, input, windows);
+
+	EXPECT_TRUE(runner.TryRun("sleep 0x10"));
+	EXPECT_TRUE(runner.TryRun("sleep 100"));
+	EXPECT_TRUE(runner.TryRun("sleep soon"));
+	EXPECT_EQ(1116u, clock.now);
+
+	EXPECT_TRUE(runner.TryRun("switchwindow"));
+	EXPECT_TRUE(runner.TryRun("switchwindow Notepad++ - new 1"));
+	EXPECT_EQ((std::vector<std::string>{ "", "Notepad++ - new 1" }), windows.activated);
+}
+
+TEST(CustomCommandRunner, LeavesConsoleCommands) {
+	TestClock clock;
+	RecordingInputSink input;
+	RecordingWindowLocator windows;
+	CustomCommandRunner runner(clock, input, windows);
+
+	EXPECT_FALSE(runner.TryRun("player.cast 0003f9ed player voice"));
+	EXPECT_FALSE(runner.Run(CustomCommandRunner::Parse("player.cast 0003f9ed player voice")));
+	EXPECT_TRUE(input.Events().empty());
+}
@@ -0,0 +1,65 @@
+#include "EquipBatch.h"
+#include "TestHarness.h"
+#include <vector>
+
+static PendingEquip pendingEquip(uint32_t formId, EquipSlotMask slots) {
+	PendingEquip equip = {};
+	equip.item.TESFormId = formId;
+	equip.slots = slots;
+	return equip;
+}
+
+static std::vector<uint32_t> formIds(const std::vector<PendingEquip> &batch) {
+	std::vector<uint32_t> ids;
+	for (const PendingEquip &equip : batch) {
+		ids.push_back(equip.item.TESFormId);
+	}
+	return ids;
+}
+
+TEST(CoalesceEquips, KeepsLastEquipOfASlot) {
+	std::vector<PendingEquip> batch = {
+		pendingEquip(1, kEquipSlot_RightHand),
+		pendingEquip(2, kEquipSlot_Voice),
+		pendingEquip(3, kEquipSlot_RightHand),
+		pendingEquip(4, kEquipSlot_LeftHand),
+	};
+	EXPECT_EQ(1u, CoalesceEquips(batch));
+	EXPECT_EQ((std::vector<uint32_t>{ 2, 3, 4 }), formIds(batch));
+}
+
+TEST(CoalesceEquips, KeepsPartlySupersededEquips) {
+	// A two-handed weapon is only dropped once both hands are taken by later equips
+	const EquipSlotMask bothHands = kEquipSlot_RightHand | kEquipSlot_LeftHand;
+	std::vector<PendingEquip> batch = {
+		pendingEquip(1, bothHands),
+		pendingEquip(2, kEquipSlot_RightHand),
+		pendingEquip(3, bothHands),
+		pendingEquip(4, kEquipSlot_LeftHand),
+	};
+	EXPECT_EQ(2u, CoalesceEquips(batch));
+	EXPECT_EQ((std::vector<uint32_t>{ 3, 4 }), formIds(batch));
+}
+
+TEST(CoalesceEquips, ArmorSlots) {
+	std::vector<PendingEquip> batch = {
+		pendingEquip(1, 0x4 | 0x8),  // body and hands
+		pendingEquip(2, 0x4),
+		pendingEquip(3, 0x8),
+	};
+	EXPECT_EQ(1u, CoalesceEquips(batch));
+	EXPECT_EQ((std::vector<uint32_t>{ 2, 3 }), formIds(batch));
+}
+
+TEST(CoalesceEquips, NeverDropsUnknownSlots) {
+	std::vector<PendingEquip> batch = {
+		pendingEquip(1, 0),
+		pendingEquip(2, 0),
+		pendingEquip(3, kEquipSlot_Ammo),
+	};
+	EXPECT_EQ(0u, CoalesceEquips(batch));
+	EXPECT_EQ((std::vector<uint32_t>{ 1, 2, 3 }), formIds(batch));
+
+	batch.clear();
+	EXPECT_EQ(0u, CoalesceEquips(batch));
+}
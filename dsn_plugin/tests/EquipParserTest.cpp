@@ -0,0 +1,51 @@
+#include "EquipParser.h"
+#include "TestHarness.h"
+
+TEST(ParseEquipItem, Valid) {
+	EquipItem item;
+	ASSERT_EQ(kEquipParse_Ok, ParseEquipItem("77495;-1523455213;1;2", item));
+	EXPECT_EQ(77495u, item.TESFormId);
+	EXPECT_EQ(-1523455213, item.itemId);
+	EXPECT_EQ(1, item.itemType);
+	EXPECT_EQ(2, item.hand);
+
+	ASSERT_EQ(kEquipParse_Ok, ParseEquipItem("4294967295;0;3;0", item));
+	EXPECT_EQ(4294967295u, item.TESFormId);
+	EXPECT_EQ(3, item.itemType);
+}
+
+TEST(ParseEquipItem, MissingField) {
+	EquipItem item;
+	EXPECT_EQ(kEquipParse_MissingField, ParseEquipItem("", item));
+	EXPECT_EQ(kEquipParse_MissingField, ParseEquipItem("77495;1;1", item));
+	EXPECT_EQ(kEquipParse_MissingField, ParseEquipItem("77495;;1;1", item));
+	EXPECT_EQ(kEquipParse_MissingField, ParseEquipItem("77495;1;1;", item));
+}
+
+TEST(ParseEquipItem, InvalidNumber) {
+	EquipItem item;
+	EXPECT_EQ(kEquipParse_InvalidNumber, ParseEquipItem("0x12;1;1;1", item));
+	EXPECT_EQ(kEquipParse_InvalidNumber, ParseEquipItem("77495;1;1;1 ", item));
+	EXPECT_EQ(kEquipParse_InvalidNumber, ParseEquipItem("-1;1;1;1", item));
+}
+
+TEST(ParseEquipItem, OutOfRange) {
+	EquipItem item;
+	EXPECT_EQ(kEquipParse_OutOfRange, ParseEquipItem("4294967296;1;1;1", item));
+	EXPECT_EQ(kEquipParse_OutOfRange, ParseEquipItem("77495;1;256;1", item));
+	EXPECT_EQ(kEquipParse_OutOfRange, ParseEquipItem("77495;1;4;1", item));
+	EXPECT_EQ(kEquipParse_OutOfRange, ParseEquipItem("77495;1;1;3", item));
+	EXPECT_EQ(kEquipParse_OutOfRange, ParseEquipItem("77495;1;1;-1", item));
+}
+
+TEST(ParseEquipItem, TrailingData) {
+	EquipItem item;
+	EXPECT_EQ(kEquipParse_TrailingData, ParseEquipItem("77495;1;1;1;1", item));
+}
+
+TEST(ParseEquipItem, LeavesItemOnError) {
+	EquipItem item = { 1, 2, 3, 0 };
+	EXPECT_NE(kEquipParse_Ok, ParseEquipItem("77495;5;4;1", item));
+	EXPECT_EQ(1u, item.TESFormId);
+	EXPECT_EQ(2, item.itemId);
+}
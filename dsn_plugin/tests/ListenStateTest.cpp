@@ -0,0 +1,68 @@
+#include "ListenState.h"
+#include "TestHarness.h"
+#include <string>
+
+TEST(ListenState, PausesInMenus) {
+	ListenState state;
+	state.SetPausingMenus(" Loading Menu ,Console,,");
+	std::string line;
+
+	EXPECT_FALSE(state.MenuOpenClose("InventoryMenu", true, line));
+	EXPECT_TRUE(state.IsListening());
+
+	ASSERT_TRUE(state.MenuOpenClose("Console", true, line));
+	EXPECT_EQ("LISTEN_PAUSE|Console", line);
+	EXPECT_FALSE(state.IsListening());
+	// Still paused until every pausing menu is closed
+	EXPECT_FALSE(state.MenuOpenClose("Loading Menu", true, line));
+	EXPECT_FALSE(state.MenuOpenClose("Console", false, line));
+	ASSERT_TRUE(state.MenuOpenClose("Loading Menu", false, line));
+	EXPECT_EQ("LISTEN_RESUME", line);
+	EXPECT_TRUE(state.IsListening());
+}
+
+TEST(ListenState, IgnoresACloseWithoutOpen) {
+	ListenState state;
+	state.SetPausingMenus(ListenState::kDefaultPausingMenus);
+	std::string line;
+
+	EXPECT_FALSE(state.MenuOpenClose("Loading Menu", false, line));
+	ASSERT_TRUE(state.MenuOpenClose("Main Menu", true, line));
+	EXPECT_EQ("LISTEN_PAUSE|Main Menu", line);
+	EXPECT_FALSE(state.MenuOpenClose("Main Menu", true, line));
+	EXPECT_TRUE(state.MenuOpenClose("Main Menu", false, line));
+}
+
+TEST(ListenState, PushToTalk) {
+	ListenState state;
+	std::string line;
+	EXPECT_FALSE(state.PushToTalk(false, 1000, line));
+
+	state.SetPushToTalk(true, 500);
+	ASSERT_TRUE(state.PushToTalk(false, 1000, line));
+	EXPECT_EQ("LISTEN_PAUSE|push-to-talk", line);
+	ASSERT_TRUE(state.PushToTalk(true, 1100, line));
+	EXPECT_EQ("LISTEN_RESUME", line);
+
+	// Listening until the release delay after the key is released
+	EXPECT_FALSE(state.PushToTalk(false, 1200, line));
+	EXPECT_FALSE(state.PushToTalk(false, 1699, line));
+	ASSERT_TRUE(state.PushToTalk(false, 1700, line));
+	EXPECT_EQ("LISTEN_PAUSE|push-to-talk", line);
+	EXPECT_FALSE(state.PushToTalk(false, 2000, line));
+}
+
+TEST(ListenState, MenusAndPushToTalk) {
+	ListenState state;
+	state.SetPausingMenus("Console");
+	state.SetPushToTalk(true);
+	std::string line;
+
+	// The service listens from its start, holding the key changes nothing
+	EXPECT_FALSE(state.PushToTalk(true, 1000, line));
+	ASSERT_TRUE(state.MenuOpenClose("Console", true, line));
+	EXPECT_EQ("LISTEN_PAUSE|Console", line);
+	EXPECT_FALSE(state.PushToTalk(true, 1100, line));
+	ASSERT_TRUE(state.MenuOpenClose("Console", false, line));
+	EXPECT_EQ("LISTEN_RESUME", line);
+}
@@ -0,0 +1,126 @@
+#include "OutboundWriter.h"
+#include "TestPlatform.h"
+#include "TestHarness.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Holds the writer thread in Write() until Release(), so the lines enqueued meanwhile stay queued
+class GatedPipe : public IPipe
+{
+public:
+	int Read(char *, size_t) override { return 0; }
+
+	bool Write(const char *data, size_t size) override {
+		std::unique_lock<std::mutex> lock(gateLock);
+		lines.push_back(std::string(data, size - 1));
+		gateChanged.notify_all();
+		gateChanged.wait(lock, [this] { return open; });
+		return true;
+	}
+
+	void WaitForWrites(size_t count) {
+		std::unique_lock<std::mutex> lock(gateLock);
+		gateChanged.wait(lock, [this, count] { return lines.size() >= count; });
+	}
+
+	void Release() {
+		std::lock_guard<std::mutex> lock(gateLock);
+		open = true;
+		gateChanged.notify_all();
+	}
+
+	std::vector<std::string> Lines() {
+		std::lock_guard<std::mutex> lock(gateLock);
+		return lines;
+	}
+
+private:
+	std::mutex gateLock;
+	std::condition_variable gateChanged;
+	std::vector<std::string> lines;
+	bool open = false;
+};
+
+class OutboundWriterTest
+{
+protected:
+	OutboundWriterTest() : writer(clock) {}
+
+	// Keep the writer thread busy writing `line`
+	void Block(const std::string &line) {
+		writer.SetPipe(&pipe);
+		writer.Enqueue(line);
+		pipe.WaitForWrites(1);
+	}
+
+	std::vector<std::string> ReleaseAndFlush() {
+		pipe.Release();
+		writer.Flush();
+		return pipe.Lines();
+	}
+
+	TestClock clock;
+	GatedPipe pipe;
+	OutboundWriter writer;
+};
+
+TEST_F(OutboundWriterTest, DropsLinesWithoutPipe) {
+	EXPECT_FALSE(writer.Enqueue("STOP_DIALOGUE"));
+	EXPECT_EQ(0u, writer.GetStats().depth);
+}
+
+TEST_F(OutboundWriterTest, WritesInOrder) {
+	Block("REGISTER_PHRASES|1|hello");
+	writer.Enqueue("LISTEN_PAUSE|Console");
+	writer.Enqueue("LISTEN_RESUME");
+	EXPECT_EQ(2u, writer.GetStats().depth);
+
+	EXPECT_EQ((std::vector<std::string>{ "REGISTER_PHRASES|1|hello", "LISTEN_PAUSE|Console", "LISTEN_RESUME" }),
+		ReleaseAndFlush());
+	OutboundWriter::Stats stats = writer.GetStats();
+	EXPECT_EQ(3u, stats.written);
+	EXPECT_EQ(0u, stats.superseded);
+}
+
+TEST_F(OutboundWriterTest, FavoritesReplaceTheUnsentSnapshot) {
+	Block("LISTEN_RESUME");
+	writer.Enqueue("FAVORITES|Iron Sword,1,2,1,1");
+	writer.Enqueue("LISTEN_PAUSE|Console");
+	writer.Enqueue("FAVORITES|Steel Sword,3,4,1,1");
+
+	// The newer snapshot takes the place of the older one in the queue
+	EXPECT_EQ((std::vector<std::string>{ "LISTEN_RESUME", "FAVORITES|Steel Sword,3,4,1,1", "LISTEN_PAUSE|Console" }),
+		ReleaseAndFlush());
+	EXPECT_EQ(1u, writer.GetStats().superseded);
+}
+
+TEST_F(OutboundWriterTest, StartDialogueReplacesTheUnsentOne) {
+	Block("LISTEN_RESUME");
+	writer.Enqueue("START_DIALOGUE|1|0000000000000000|Hello");
+	writer.Enqueue("START_DIALOGUE|2|0000000000000000|Goodbye");
+
+	EXPECT_EQ((std::vector<std::string>{ "LISTEN_RESUME", "START_DIALOGUE|2|0000000000000000|Goodbye" }),
+		ReleaseAndFlush());
+	EXPECT_EQ(1u, writer.GetStats().superseded);
+}
+
+TEST_F(OutboundWriterTest, StopDialogueCancelsTheUnsentStart) {
+	Block("LISTEN_RESUME");
+	writer.Enqueue("START_DIALOGUE|1|0000000000000000|Hello");
+	writer.Enqueue("STOP_DIALOGUE");
+
+	// The service never saw the dialogue, it has nothing to stop
+	EXPECT_EQ((std::vector<std::string>{ "LISTEN_RESUME" }), ReleaseAndFlush());
+	EXPECT_EQ(2u, writer.GetStats().superseded);
+}
+
+TEST_F(OutboundWriterTest, StopDialogueOfASentStart) {
+	Block("START_DIALOGUE|1|0000000000000000|Hello");
+	writer.Enqueue("STOP_DIALOGUE");
+	writer.Enqueue("STOP_DIALOGUE");
+
+	EXPECT_EQ((std::vector<std::string>{ "START_DIALOGUE|1|0000000000000000|Hello", "STOP_DIALOGUE" }), ReleaseAndFlush());
+	EXPECT_EQ(1u, writer.GetStats().superseded);
+}
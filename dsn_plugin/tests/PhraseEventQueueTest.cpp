@@ -0,0 +1,56 @@
+#include "PhraseEventQueue.h"
+#include "ResponseDispatcher.h"
+#include "TestPlatform.h"
+#include "TestHarness.h"
+#include <string>
+#include <vector>
+
+TEST(PhraseEventQueue, TakesTheEventsOfAFrame) {
+	PhraseEventQueue queue;
+	std::vector<PhraseEvent> batch;
+	EXPECT_EQ(0u, queue.TakeBatch(batch));
+
+	queue.Push(3, 0.9f, "open the door", 1000);
+	queue.Push(4, 0.5f, "close the door", 1010);
+	ASSERT_EQ(2u, queue.TakeBatch(batch));
+	EXPECT_EQ(3, batch[0].id);
+	EXPECT_EQ("open the door", batch[0].phrase);
+	EXPECT_EQ(0.5f, batch[1].confidence);
+	EXPECT_EQ(1010u, batch[1].queuedAt);
+
+	// The batch is cleared first
+	queue.Push(5, 1.0f, "lock the door", 1020);
+	ASSERT_EQ(1u, queue.TakeBatch(batch));
+	EXPECT_EQ(5, batch[0].id);
+	EXPECT_EQ(0u, queue.TakeBatch(batch));
+	EXPECT_TRUE(batch.empty());
+}
+
+TEST(PhraseEventQueue, DropsTheOldestEvents) {
+	PhraseEventQueue queue;
+	for (size_t i = 0; i < PhraseEventQueue::kMaxQueued + 10; i++) {
+		queue.Push((int)i, 1.0f, "open the door", 1000);
+	}
+
+	std::vector<PhraseEvent> batch;
+	ASSERT_EQ(PhraseEventQueue::kMaxQueued, queue.TakeBatch(batch));
+	EXPECT_EQ(10, batch.front().id);
+	EXPECT_EQ(10u, queue.Dropped());
+}
+
+TEST(PhraseEventQueue, DispatchedPapyrusEvents) {
+	TestClock clock;
+	ResponseDispatcher dispatcher(clock, nullptr);
+	dispatcher.Dispatch("PAPYRUS_EVENT|7|0.91|open the door|now");
+	dispatcher.Dispatch("PAPYRUS_EVENT|x|0.91|open the door");
+	// The service writes the confidence with the invariant culture, whatever the locale
+	dispatcher.Dispatch("PAPYRUS_EVENT|8|0,91|open the door");
+
+	std::vector<PhraseEvent> batch;
+	dispatcher.PopPhraseEvents(batch);
+	ASSERT_EQ(1u, batch.size());
+	EXPECT_EQ(7, batch[0].id);
+	EXPECT_EQ(0.91f, batch[0].confidence);
+	// The phrase is the rest of the line
+	EXPECT_EQ("open the door|now", batch[0].phrase);
+}
@@ -0,0 +1,69 @@
+#include "PhraseRegistry.h"
+#include "TestHarness.h"
+#include <string>
+#include <vector>
+
+struct Recognitions {
+	std::vector<uint32_t> ids;
+	PhraseRegistry *unregisterFrom = nullptr;
+};
+
+static void recordRecognition(uint32_t phraseId, void *userData) {
+	Recognitions *recognitions = (Recognitions *)userData;
+	recognitions->ids.push_back(phraseId);
+	if (recognitions->unregisterFrom) {
+		recognitions->unregisterFrom->Unregister(phraseId);
+	}
+}
+
+TEST(PhraseRegistry, BatchesRegistrations) {
+	PhraseRegistry registry;
+	Recognitions recognitions;
+	std::vector<std::string> lines;
+	registry.TakePendingLines(lines);
+	EXPECT_TRUE(lines.empty());
+
+	EXPECT_EQ(1u, registry.Register("open the door", recordRecognition, &recognitions));
+	EXPECT_EQ(2u, registry.Register("  close|the\ndoor ", recordRecognition, &recognitions));
+	EXPECT_TRUE(registry.Unregister(1));
+	EXPECT_FALSE(registry.Unregister(1));
+	EXPECT_EQ(1u, registry.Size());
+
+	registry.TakePendingLines(lines);
+	EXPECT_EQ((std::vector<std::string>{ "REGISTER_PHRASES|1|open the door|2|close the door", "UNREGISTER_PHRASES|1" }), lines);
+
+	lines.clear();
+	registry.TakePendingLines(lines);
+	EXPECT_TRUE(lines.empty());
+}
+
+TEST(PhraseRegistry, RejectsEmptyPhrases) {
+	PhraseRegistry registry;
+	Recognitions recognitions;
+	EXPECT_EQ(0u, registry.Register("", recordRecognition, &recognitions));
+	EXPECT_EQ(0u, registry.Register(" | ", recordRecognition, &recognitions));
+	EXPECT_EQ(0u, registry.Register("open the door", nullptr, &recognitions));
+	EXPECT_EQ(0u, registry.Size());
+}
+
+TEST(PhraseRegistry, Deliver) {
+	PhraseRegistry registry;
+	Recognitions first, second;
+	uint32_t open = registry.Register("open the door", recordRecognition, &first);
+	uint32_t close = registry.Register("close the door", recordRecognition, &second);
+	registry.Unregister(close);
+
+	EXPECT_EQ(2u, registry.Deliver({ open, close, open, 42 }));
+	EXPECT_EQ((std::vector<uint32_t>{ open, open }), first.ids);
+	EXPECT_TRUE(second.ids.empty());
+}
+
+TEST(PhraseRegistry, CallbackCanUnregister) {
+	PhraseRegistry registry;
+	Recognitions recognitions;
+	recognitions.unregisterFrom = &registry;
+	uint32_t id = registry.Register("open the door", recordRecognition, &recognitions);
+
+	EXPECT_EQ(1u, registry.Deliver({ id, id }));
+	EXPECT_EQ(0u, registry.Size());
+}
@@ -0,0 +1,177 @@
+#include "ResponseDispatcher.h"
+#include "CustomCommands.h"
+#include "TestPlatform.h"
+#include "TestHarness.h"
+#include <string>
+#include <vector>
+
+// Dispatcher running custom commands with a recording input sink, like the plugin does
+class ResponseDispatcherTest
+{
+protected:
+	ResponseDispatcherTest()
+		: runner(clock, input, windows),
+		dispatcher(clock, [this](const ParsedCommand &command) { return runner.Run(command); }) {
+	}
+
+	// Console commands queued for the game thread, in order
+	std::vector<std::string> PopCommands() {
+		std::vector<std::string> commands;
+		for (std::string command = dispatcher.PopCommand(); !command.empty(); command = dispatcher.PopCommand()) {
+			commands.push_back(command);
+		}
+		return commands;
+	}
+
+	TestClock clock;
+	RecordingInputSink input;
+	RecordingWindowLocator windows;
+	CustomCommandRunner runner;
+	ResponseDispatcher dispatcher;
+};
+
+TEST_F(ResponseDispatcherTest, DialogueSelection) {
+	int dialogueId = dispatcher.StartDialogue();
+	dispatcher.Dispatch("DIALOGUE|" + std::to_string(dialogueId - 1) + "|1");
+	EXPECT_EQ(-1, dispatcher.ReadSelectedIndex());
+
+	clock.now += 20;
+	dispatcher.Dispatch("DIALOGUE|" + std::to_string(dialogueId) + "|2");
+	uint64_t selectedAt = 0;
+	EXPECT_EQ(2, dispatcher.ReadSelectedIndex(&selectedAt));
+	EXPECT_EQ(1020u, selectedAt);
+	EXPECT_EQ(-1, dispatcher.ReadSelectedIndex());
+	EXPECT_EQ(1u, dispatcher.GetLaneStats(kLane_Dialogue).count);
+}
+
+TEST_F(ResponseDispatcherTest, Equips) {
+	dispatcher.Dispatch("EQUIP|77495;-1523455213;1;1");
+	dispatcher.Dispatch("EQUIP|77495;1;9;1");
+	dispatcher.Dispatch("EQUIP|12;0;2;2");
+
+	std::vector<EquipItem> equips;
+	dispatcher.PopEquips(equips);
+	ASSERT_EQ(2u, equips.size());
+	EXPECT_EQ(77495u, equips[0].TESFormId);
+	EXPECT_EQ(12u, equips[1].TESFormId);
+	EXPECT_EQ(2u, dispatcher.GetLaneStats(kLane_Equip).count);
+
+	equips.clear();
+	dispatcher.PopEquips(equips);
+	EXPECT_TRUE(equips.empty());
+}
+
+TEST_F(ResponseDispatcherTest, CommandLane) {
+	dispatcher.Dispatch("COMMAND|holdkey shift;player.say a;tapkey r;releasekey shift;player.say b");
+	dispatcher.FlushCommands();
+
+	// Custom commands ran on the command lane, console commands wait for the game thread in order
+	EXPECT_EQ((std::vector<std::string>{ "+42", "+19", "-19", "-42" }), input.Events());
+	uint64_t queuedAt = 0;
+	EXPECT_EQ("player.say a", dispatcher.PopCommand(&queuedAt));
+	EXPECT_EQ(1000u, queuedAt);
+	EXPECT_EQ((std::vector<std::string>{ "player.say b" }), PopCommands());
+	EXPECT_EQ("", dispatcher.PopCommand());
+	EXPECT_EQ(5u, dispatcher.GetLaneStats(kLane_Command).count);
+}
+
+TEST_F(ResponseDispatcherTest, EnqueueCommand) {
+	dispatcher.EnqueueCommand("tapkey r");
+	dispatcher.EnqueueCommand("player.say a");
+	dispatcher.FlushCommands();
+
+	EXPECT_EQ((std::vector<std::string>{ "+19", "-19" }), input.Events());
+	EXPECT_EQ((std::vector<std::string>{ "player.say a" }), PopCommands());
+}
+
+TEST_F(ResponseDispatcherTest, WithoutCustomCommandHandler) {
+	ResponseDispatcher consoleOnly(clock, nullptr);
+	consoleOnly.Dispatch("COMMAND|tapkey r;player.say a");
+	consoleOnly.FlushCommands();
+
+	EXPECT_EQ("tapkey r", consoleOnly.PopCommand());
+	EXPECT_EQ("player.say a", consoleOnly.PopCommand());
+	EXPECT_TRUE(input.Events().empty());
+}
+
+TEST_F(ResponseDispatcherTest, CommandIds) {
+	dispatcher.Dispatch("REGISTER_COMMANDS|0|tapkey r;player.say a|1|player.say b");
+	dispatcher.Dispatch("COMMAND_ID|1");
+	dispatcher.Dispatch("COMMAND_ID|0");
+	dispatcher.Dispatch("COMMAND_ID|7");
+	dispatcher.FlushCommands();
+
+	EXPECT_EQ((std::vector<std::string>{ "+19", "-19" }), input.Events());
+	EXPECT_EQ((std::vector<std::string>{ "player.say b", "player.say a" }), PopCommands());
+	EXPECT_EQ(1u, dispatcher.GetUnknownCommandIds());
+}
+
+TEST_F(ResponseDispatcherTest, SuppressesRepeatedCommands) {
+	dispatcher.Dispatch("COMMAND|player.say a");
+	dispatcher.Dispatch("COMMAND|player.say a");
+	dispatcher.FlushCommands();
+
+	EXPECT_EQ((std::vector<std::string>{ "player.say a" }), PopCommands());
+	EXPECT_EQ(1u, dispatcher.GetSuppressedRepeats());
+
+	dispatcher.SetRepeatWindow(0);
+	dispatcher.Dispatch("COMMAND|player.say a");
+	dispatcher.FlushCommands();
+	EXPECT_EQ((std::vector<std::string>{ "player.say a" }), PopCommands());
+}
+
+TEST_F(ResponseDispatcherTest, ExpiredCommandsAreDropped) {
+	// Recognized 100 ms before it was received, with a deadline of 50 ms
+	dispatcher.Dispatch("COMMAND|player.say a;holdkey r;player.say b|50|100");
+	dispatcher.Dispatch("COMMAND|player.say c|50|0");
+	dispatcher.Dispatch("COMMAND|player.say d");
+	dispatcher.FlushCommands();
+
+	clock.now += 100;
+	EXPECT_EQ((std::vector<std::string>{ "player.say d" }), PopCommands());
+	EXPECT_TRUE(input.Events().empty());
+	EXPECT_EQ(4u, dispatcher.GetLaneStats(kLane_Command).expired);
+}
+
+TEST_F(ResponseDispatcherTest, StartedMacroIsNotCut) {
+	// The sleep passes the deadline after the key is held, the rest of the macro still runs
+	dispatcher.Dispatch("COMMAND|holdkey shift;sleep 100;player.say x;releasekey shift|50|0");
+	dispatcher.FlushCommands();
+
+	EXPECT_EQ((std::vector<std::string>{ "+42", "-42" }), input.Events());
+	EXPECT_EQ((std::vector<std::string>{ "player.say x" }), PopCommands());
+	EXPECT_EQ(0u, dispatcher.GetLaneStats(kLane_Command).expired);
+}
+
+TEST_F(ResponseDispatcherTest, ConsoleCommandsOfAMacroStartedOnTheLane) {
+	// The console command is queued before the lane starts the macro with the custom command
+	dispatcher.Dispatch("COMMAND|player.say a;tapkey r|50|0");
+	dispatcher.FlushCommands();
+
+	clock.now += 100;
+	EXPECT_EQ((std::vector<std::string>{ "player.say a" }), PopCommands());
+	EXPECT_EQ(0u, dispatcher.GetLaneStats(kLane_Command).expired);
+}
+
+TEST_F(ResponseDispatcherTest, MacroStartedByTheGameThread) {
+	dispatcher.Dispatch("COMMAND|player.say a;player.say b|50|0");
+	dispatcher.FlushCommands();
+
+	EXPECT_EQ("player.say a", dispatcher.PopCommand());
+	clock.now += 100;
+	// Past the deadline, but the game thread already ran the first command of the macro
+	EXPECT_EQ("player.say b", dispatcher.PopCommand());
+	EXPECT_EQ(0u, dispatcher.GetLaneStats(kLane_Command).expired);
+}
+
+TEST_F(ResponseDispatcherTest, RecognizedPhrases) {
+	dispatcher.Dispatch("PHRASE|3");
+	dispatcher.Dispatch("PHRASE|0");
+	dispatcher.Dispatch("PHRASE|5");
+
+	std::vector<uint32_t> phrases;
+	dispatcher.PopPhrases(phrases);
+	EXPECT_EQ((std::vector<uint32_t>{ 3, 5 }), phrases);
+	dispatcher.PopPhrases(phrases);
+	EXPECT_EQ(2u, phrases.size());
+}
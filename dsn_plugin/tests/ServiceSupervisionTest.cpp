@@ -0,0 +1,75 @@
+#include "ServiceSupervision.h"
+#include "TestHarness.h"
+#include <string>
+#include <vector>
+
+TEST(RestartBackoff, DoublesUpToTheMaximum) {
+	RestartBackoff backoff;
+	EXPECT_EQ(RestartBackoff::kInitialDelay, backoff.NextDelay(0));
+	EXPECT_EQ(2 * RestartBackoff::kInitialDelay, backoff.NextDelay(100));
+	EXPECT_EQ(4 * RestartBackoff::kInitialDelay, backoff.NextDelay(RestartBackoff::kStableRunTime - 1));
+	EXPECT_EQ(3u, backoff.Attempts());
+
+	uint32_t delay = 0;
+	for (int i = 0; i < 20; i++) {
+		delay = backoff.NextDelay(0);
+	}
+	EXPECT_EQ(RestartBackoff::kMaxDelay, delay);
+}
+
+TEST(RestartBackoff, ResetsAfterAStableRun) {
+	RestartBackoff backoff;
+	backoff.NextDelay(0);
+	backoff.NextDelay(0);
+	EXPECT_EQ(RestartBackoff::kInitialDelay, backoff.NextDelay(RestartBackoff::kStableRunTime));
+	EXPECT_EQ(1u, backoff.Attempts());
+}
+
+TEST(ServiceState, NothingToRestore) {
+	ServiceState state;
+	state.Remember("STOP_DIALOGUE");
+	state.Remember("LISTEN_RESUME");
+
+	std::vector<std::string> lines;
+	state.GetRestoreLines(lines);
+	EXPECT_TRUE(lines.empty());
+}
+
+TEST(ServiceState, RestoresInOrder) {
+	ServiceState state;
+	state.Remember("LISTEN_PAUSE|Console");
+	state.Remember("START_DIALOGUE|4|0000000000000000|Hello");
+	state.Remember("FAVORITES|Iron Sword,1,2,1,1");
+	state.Remember("REGISTER_PHRASES|7|open the door|2|close the door");
+	state.Remember("COMMAND|ignored");
+
+	std::vector<std::string> lines = { "READY|all|0" };
+	state.GetRestoreLines(lines);
+	EXPECT_EQ((std::vector<std::string>{
+		"READY|all|0",
+		"REGISTER_PHRASES|2|close the door|7|open the door",
+		"FAVORITES|Iron Sword,1,2,1,1",
+		"START_DIALOGUE|4|0000000000000000|Hello",
+		"LISTEN_PAUSE|Console",
+	}), lines);
+}
+
+TEST(ServiceState, KeepsTheLatestState) {
+	ServiceState state;
+	state.Remember("REGISTER_PHRASES|1|open the door|2|close the door|3|lock the door");
+	state.Remember("REGISTER_PHRASES|1|open the gate");
+	state.Remember("UNREGISTER_PHRASES|2|9");
+	state.Remember("FAVORITES|Iron Sword,1,2,1,1");
+	state.Remember("FAVORITES|Steel Sword,3,4,1,1");
+	state.Remember("START_DIALOGUE|4|0000000000000000|Hello");
+	state.Remember("STOP_DIALOGUE");
+	state.Remember("LISTEN_PAUSE|Console");
+	state.Remember("LISTEN_RESUME");
+
+	std::vector<std::string> lines;
+	state.GetRestoreLines(lines);
+	EXPECT_EQ((std::vector<std::string>{
+		"REGISTER_PHRASES|1|open the gate|3|lock the door",
+		"FAVORITES|Steel Sword,3,4,1,1",
+	}), lines);
+}
@@ -0,0 +1,91 @@
+#include "SpeechProtocol.h"
+#include "TestPlatform.h"
+#include "TestHarness.h"
+#include <string>
+#include <vector>
+
+TEST(ParseResponse, Dialogue) {
+	Response response;
+	ASSERT_TRUE(ParseResponse("DIALOGUE|3|1", response));
+	EXPECT_EQ(kResponse_Dialogue, response.type);
+	EXPECT_EQ(3, response.dialogueId);
+	EXPECT_EQ(1, response.index);
+}
+
+TEST(ParseResponse, MalformedDialogue) {
+	Response response;
+	EXPECT_FALSE(ParseResponse("DIALOGUE|3|", response));
+	EXPECT_FALSE(ParseResponse("DIALOGUE|x|1", response));
+	EXPECT_EQ(kResponse_Unknown, response.type);
+}
+
+TEST(ParseResponse, Command) {
+	Response response;
+	ASSERT_TRUE(ParseResponse("COMMAND|tapkey r;player.additem f 100", response));
+	EXPECT_EQ(kResponse_Command, response.type);
+	EXPECT_EQ("tapkey r;player.additem f 100", response.payload);
+	EXPECT_EQ(0, response.deadline);
+	EXPECT_EQ(0, response.age);
+}
+
+TEST(ParseResponse, CommandDeadline) {
+	Response response;
+	ASSERT_TRUE(ParseResponse("COMMAND|tapkey r|1500|12", response));
+	EXPECT_EQ("tapkey r", response.payload);
+	EXPECT_EQ(1500, response.deadline);
+	EXPECT_EQ(12, response.age);
+
+	// Both optional fields are ignored if either is malformed
+	ASSERT_TRUE(ParseResponse("COMMAND|tapkey r|1500|x", response));
+	EXPECT_EQ(0, response.deadline);
+	EXPECT_EQ(0, response.age);
+	ASSERT_TRUE(ParseResponse("COMMAND|tapkey r|-1|0", response));
+	EXPECT_EQ(0, response.deadline);
+}
+
+TEST(ParseResponse, EquipAndReady) {
+	Response response;
+	ASSERT_TRUE(ParseResponse("EQUIP|77495;-1523455213;1;1", response));
+	EXPECT_EQ(kResponse_Equip, response.type);
+	EXPECT_EQ("77495;-1523455213;1;1", response.payload);
+
+	ASSERT_TRUE(ParseResponse("READY|grammars|195", response));
+	EXPECT_EQ(kResponse_Ready, response.type);
+	EXPECT_EQ("grammars", response.payload);
+	EXPECT_EQ(195, response.elapsed);
+	EXPECT_FALSE(ParseResponse("READY||195", response));
+}
+
+TEST(ParseResponse, Unknown) {
+	Response response;
+	EXPECT_FALSE(ParseResponse("", response));
+	EXPECT_FALSE(ParseResponse("EQUIP", response));
+	EXPECT_FALSE(ParseResponse("HELLO|1", response));
+	EXPECT_EQ(kResponse_Unknown, response.type);
+}
+
+TEST(SplitCommands, SkipsEmptyCommands) {
+	std::vector<std::string_view> commands;
+	SplitCommands(";press m;;sleep 100;", commands);
+	ASSERT_EQ(2u, commands.size());
+	EXPECT_EQ("press m", commands[0]);
+	EXPECT_EQ("sleep 100", commands[1]);
+}
+
+TEST(LineReader, SplitsLinesAcrossReads) {
+	TestPipe pipe;
+	TestClock clock;
+	pipe.data = "DIALOGUE|1|0\nCOMMAND|tapkey r\nREADY|all|3";
+	pipe.chunkSize = 5;
+	pipe.emptyReads = 2;
+	LineReader reader(pipe, clock, 10);
+
+	std::string line;
+	ASSERT_TRUE(reader.ReadLine(line));
+	EXPECT_EQ("DIALOGUE|1|0", line);
+	EXPECT_EQ(1020u, clock.now);  // waited twice for data
+	ASSERT_TRUE(reader.ReadLine(line));
+	EXPECT_EQ("COMMAND|tapkey r", line);
+	// The last line has no '\n' when the pipe closes
+	EXPECT_FALSE(reader.ReadLine(line));
+}
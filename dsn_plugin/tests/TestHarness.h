@@ -0,0 +1,96 @@
+#pragma once
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Minimal unit test harness of dsn_tests, with the GoogleTest style macros the tests use:
+//
+//   TEST(Suite, Name) { ... }
+//   TEST_F(Fixture, Name) { ... }    the body is a member function of a class derived from Fixture
+//
+// EXPECT_* report a failure and continue the test, ASSERT_* report it and end the test.
+// TestMain.cpp runs every test, or those whose "Suite.Name" contains the first argument.
+
+namespace TestHarness {
+
+struct TestCase {
+	const char *suite;
+	const char *name;
+	void (*run)();
+};
+
+std::vector<TestCase> &Tests();
+
+struct Registrar {
+	Registrar(const char *suite, const char *name, void (*run)()) { Tests().push_back({ suite, name, run }); }
+};
+
+// Thrown by the ASSERT_* macros to end the test
+struct AssertionAbort {};
+
+void ReportFailure(const char *file, int line, const std::string &message);
+
+template<typename T, typename = void>
+struct IsPrintable : std::false_type {};
+template<typename T>
+struct IsPrintable<T, std::void_t<decltype(std::declval<std::ostream &>() << std::declval<const T &>())>> : std::true_type {};
+
+template<typename T>
+std::string Print(const T &value) {
+	if constexpr (IsPrintable<T>::value) {
+		std::ostringstream out;
+		out << value;
+		return out.str();
+	}
+	else {
+		return "<not printable>";
+	}
+}
+
+template<typename Expected, typename Actual>
+bool CheckEqual(bool equal, const Expected &expected, const Actual &actual, const char *expectedText, const char *actualText,
+	const char *op, const char *file, int line) {
+	if (!equal) {
+		ReportFailure(file, line, std::string("Expected ") + expectedText + " " + op + " " + actualText
+			+ "\n  " + expectedText + ": " + Print(expected) + "\n  " + actualText + ": " + Print(actual));
+	}
+	return equal;
+}
+
+inline bool CheckCondition(bool condition, const char *text, const char *file, int line) {
+	if (!condition) {
+		ReportFailure(file, line, std::string("Expected ") + text);
+	}
+	return condition;
+}
+
+}
+
+#define TEST(suite, name) \
+	static void suite##_##name##_Test(); \
+	static TestHarness::Registrar suite##_##name##_Registrar(#suite, #name, &suite##_##name##_Test); \
+	static void suite##_##name##_Test()
+
+#define TEST_F(fixture, name) \
+	class fixture##_##name##_Test : public fixture { public: void Body(); }; \
+	static void fixture##_##name##_Run() { fixture##_##name##_Test test; test.Body(); } \
+	static TestHarness::Registrar fixture##_##name##_Registrar(#fixture, #name, &fixture##_##name##_Run); \
+	void fixture##_##name##_Test::Body()
+
+#define DSN_CHECK_EQ(expected, actual, equal, op) \
+	[&](const auto &e, const auto &a) { \
+		return TestHarness::CheckEqual(equal, e, a, #expected, #actual, op, __FILE__, __LINE__); \
+	}((expected), (actual))
+
+#define EXPECT_EQ(expected, actual) DSN_CHECK_EQ(expected, actual, e == a, "==")
+#define EXPECT_NE(expected, actual) DSN_CHECK_EQ(expected, actual, !(e == a), "!=")
+#define EXPECT_TRUE(condition) TestHarness::CheckCondition(!!(condition), #condition, __FILE__, __LINE__)
+#define EXPECT_FALSE(condition) TestHarness::CheckCondition(!(condition), "!(" #condition ")", __FILE__, __LINE__)
+
+#define ASSERT_EQ(expected, actual) do { if (!EXPECT_EQ(expected, actual)) throw TestHarness::AssertionAbort(); } while (0)
+#define ASSERT_NE(expected, actual) do { if (!EXPECT_NE(expected, actual)) throw TestHarness::AssertionAbort(); } while (0)
+#define ASSERT_TRUE(condition) do { if (!EXPECT_TRUE(condition)) throw TestHarness::AssertionAbort(); } while (0)
+#define ASSERT_FALSE(condition) do { if (!EXPECT_FALSE(condition)) throw TestHarness::AssertionAbort(); } while (0)
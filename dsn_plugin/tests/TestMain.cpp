@@ -0,0 +1,59 @@
+#include "TestHarness.h"
+#include <cstdio>
+#include <exception>
+#include <string>
+
+namespace TestHarness {
+
+static int failures = 0;
+
+std::vector<TestCase> &Tests() {
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+void ReportFailure(const char *file, int line, const std::string &message) {
+	failures++;
+	printf("%s:%d: Failure\n%s\n", file, line, message.c_str());
+}
+
+}
+
+int main(int argc, char **argv) {
+	using namespace TestHarness;
+
+	const char *filter = argc > 1 ? argv[1] : "";
+	int run = 0;
+	std::vector<std::string> failed;
+	for (const TestCase &test : Tests()) {
+		std::string name = std::string(test.suite) + "." + test.name;
+		if (name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		printf("[ RUN      ] %s\n", name.c_str());
+		int failuresBefore = failures;
+		try {
+			test.run();
+		}
+		catch (const AssertionAbort &) {
+		}
+		catch (const std::exception &e) {
+			ReportFailure(__FILE__, __LINE__, std::string("Uncaught exception: ") + e.what());
+		}
+		run++;
+		if (failures == failuresBefore) {
+			printf("[       OK ] %s\n", name.c_str());
+		}
+		else {
+			printf("[  FAILED  ] %s\n", name.c_str());
+			failed.push_back(name);
+		}
+	}
+
+	printf("%d tests ran, %d failed\n", run, (int)failed.size());
+	for (const std::string &name : failed) {
+		printf("[  FAILED  ] %s\n", name.c_str());
+	}
+	return failed.empty() ? 0 : 1;
+}
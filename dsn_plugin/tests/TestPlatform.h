@@ -0,0 +1,86 @@
+#pragma once
+#include "Platform.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Platform.h implementations for the unit tests: nothing sleeps, no input is sent.
+// They can be shared with the command lane's thread.
+
+// Advances its time instead of sleeping
+class TestClock : public IClock
+{
+public:
+	std::atomic<uint64_t> now{ 1000 };
+
+	uint64_t NowMilliseconds() override { return now; }
+	void SleepMilliseconds(uint32_t milliseconds) override { now += milliseconds; }
+};
+
+// Records the key events, as "+<scan code>" for a key down and "-<scan code>" for a key up
+class RecordingInputSink : public IInputSink
+{
+public:
+	void KeyDown(uint32_t scanCode) override { Record('+', scanCode); }
+	void KeyUp(uint32_t scanCode) override { Record('-', scanCode); }
+
+	std::vector<std::string> Events() {
+		std::lock_guard<std::mutex> lock(eventsLock);
+		return events;
+	}
+
+private:
+	void Record(char direction, uint32_t scanCode) {
+		std::lock_guard<std::mutex> lock(eventsLock);
+		events.push_back(direction + std::to_string(scanCode));
+	}
+
+	std::mutex eventsLock;
+	std::vector<std::string> events;
+};
+
+// Records the activated windows
+class RecordingWindowLocator : public IWindowLocator
+{
+public:
+	std::vector<std::string> activated;
+
+	bool ActivateWindow(const std::string &name) override {
+		activated.push_back(name);
+		return true;
+	}
+};
+
+// Returns no data for the first `emptyReads` reads, then `data` in reads of at most `chunkSize` bytes,
+// then reports the pipe as closed. Writes are recorded.
+class TestPipe : public IPipe
+{
+public:
+	std::string data;
+	size_t chunkSize = 4096;
+	size_t position = 0;
+	int emptyReads = 0;
+	std::string written;
+
+	int Read(char *buffer, size_t size) override {
+		if (emptyReads > 0) {
+			emptyReads--;
+			return 0;
+		}
+		if (position >= data.size()) {
+			return -1;
+		}
+		size_t count = std::min(std::min(size, chunkSize), data.size() - position);
+		memcpy(buffer, data.data() + position, count);
+		position += count;
+		return (int)count;
+	}
+
+	bool Write(const char *buffer, size_t size) override {
+		written.append(buffer, size);
+		return true;
+	}
+};
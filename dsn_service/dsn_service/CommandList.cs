@@ -20,10 +20,19 @@ namespace DSN {
                     list.commandsByPhrase[grammar] = key.Value.Trim();
                 }
             }
+            list.AssignCommandIds();
             return list;
         }
 
         public Dictionary<Grammar, string> commandsByPhrase = new Dictionary<Grammar, string>();
+        public Dictionary<Grammar, int> deadlinesByPhrase = new Dictionary<Grammar, int>();
+        private int defaultDeadline = 0;
+        private Dictionary<Grammar, int> papyrusEventsByPhrase = new Dictionary<Grammar, int>();
+
+        // Skyrim learns the commands once with REGISTER_COMMANDS, recognized phrases are sent by id.
+        // Phrases with the same commands share their id.
+        private Dictionary<Grammar, int> idsByPhrase = new Dictionary<Grammar, int>();
+        private List<string> commandsById = new List<string>();
 
         public string GetCommandForPhrase(Grammar grammar) {
             if (commandsByPhrase.ContainsKey(grammar))
@@ -31,6 +40,95 @@ namespace DSN {
             return null;
         }
 
+        // Milliseconds after its recognition a phrase's commands are dropped by Skyrim if they have not run yet, 0 for never.
+        // Phrases without a deadline in `sectionData` (phrase=milliseconds) use `defaultDeadline`.
+        public void SetDeadlines(KeyDataCollection sectionData, int defaultDeadline) {
+            this.defaultDeadline = defaultDeadline;
+            deadlinesByPhrase.Clear();
+            if (sectionData == null)
+                return;
+
+            foreach (Grammar grammar in commandsByPhrase.Keys) {
+                string value = sectionData[grammar.Name];
+                int deadline;
+                if (value == null)
+                    continue;
+                if (int.TryParse(value.Trim(), out deadline) && deadline >= 0) {
+                    deadlinesByPhrase[grammar] = deadline;
+                    Trace.TraceInformation("Phrase '{0}' expires {1} ms after its recognition", grammar.Name, deadline);
+                } else {
+                    Trace.TraceError("Invalid deadline '{0}' for phrase '{1}'", value, grammar.Name);
+                }
+            }
+        }
+
+        // Returns the id of the phrase's commands, or -1 if they are not registered and must be sent as text
+        public int GetCommandIdForPhrase(Grammar grammar) {
+            if (idsByPhrase.ContainsKey(grammar))
+                return idsByPhrase[grammar];
+            return -1;
+        }
+
+        // REGISTER_COMMANDS|<id>|<commands>|<id>|<commands>..., the table of the ids used by GetCommandIdForPhrase()
+        public string GetRegisterCommandsMessage() {
+            StringBuilder message = new StringBuilder("REGISTER_COMMANDS");
+            for (int id = 0; id < commandsById.Count; id++) {
+                message.Append('|').Append(id).Append('|').Append(commandsById[id]);
+            }
+            return message.ToString();
+        }
+
+        private void AssignCommandIds() {
+            Dictionary<string, int> idsByCommands = new Dictionary<string, int>();
+            foreach (KeyValuePair<Grammar, string> entry in commandsByPhrase) {
+                // '|' would split the table, such commands are still sent as text
+                string commands = entry.Value.Replace("\r", "");
+                if (commands.Length == 0 || commands.Contains("|"))
+                    continue;
+
+                int id;
+                if (!idsByCommands.TryGetValue(commands, out id)) {
+                    id = commandsById.Count;
+                    idsByCommands[commands] = id;
+                    commandsById.Add(commands);
+                }
+                idsByPhrase[entry.Key] = id;
+            }
+        }
+
+        // Phrases that also send an event to Papyrus scripts when they are recognized, from `sectionData` (phrase=id)
+        public void SetPapyrusEvents(KeyDataCollection sectionData) {
+            papyrusEventsByPhrase.Clear();
+            if (sectionData == null)
+                return;
+
+            foreach (Grammar grammar in commandsByPhrase.Keys) {
+                string value = sectionData[grammar.Name];
+                int id;
+                if (value == null)
+                    continue;
+                if (int.TryParse(value.Trim(), out id)) {
+                    papyrusEventsByPhrase[grammar] = id;
+                    Trace.TraceInformation("Phrase '{0}' sends Papyrus events with id {1}", grammar.Name, id);
+                } else {
+                    Trace.TraceError("Invalid Papyrus event id '{0}' for phrase '{1}'", value, grammar.Name);
+                }
+            }
+        }
+
+        // Returns the id of the phrase's Papyrus event, or null if it has none
+        public int? GetPapyrusEventForPhrase(Grammar grammar) {
+            if (papyrusEventsByPhrase.ContainsKey(grammar))
+                return papyrusEventsByPhrase[grammar];
+            return null;
+        }
+
+        public int GetDeadlineForPhrase(Grammar grammar) {
+            if (deadlinesByPhrase.ContainsKey(grammar))
+                return deadlinesByPhrase[grammar];
+            return defaultDeadline;
+        }
+
         public void PrintToTrace() {
             Trace.TraceInformation("Command List Phrases:");
             foreach (KeyValuePair<Grammar, string> entry in commandsByPhrase) {
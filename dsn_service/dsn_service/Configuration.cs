@@ -66,6 +66,8 @@ namespace DSN {
         public CommandList GetConsoleCommandList() {
             if (consoleCommandList == null) {
                 consoleCommandList = CommandList.FromIniSection(merged, "ConsoleCommands");
+                consoleCommandList.SetDeadlines(merged.Sections["CommandDeadlines"], int.Parse(Get("SpeechRecognition", "commandDeadline", "0")));
+                consoleCommandList.SetPapyrusEvents(merged.Sections["PapyrusEvents"]);
                 
                 consoleCommandList.PrintToTrace();
             }
@@ -20,6 +20,8 @@ namespace DSN
         // Saved state, used to restore after reloading the configuration file.
         public string currentDialogue = null;
         public string currentFavoritesList = null;
+        public string registeredPhrases = null;
+        public string listenPause = null;
 
         public void Start()
         {
@@ -62,12 +64,18 @@ namespace DSN
         }
 
         public void RestoreSavedState() {
+            if (registeredPhrases != null) {
+                inputQueue.Add(registeredPhrases);
+            }
             if (currentFavoritesList != null) {
                 inputQueue.Add(currentFavoritesList);
             }
             if (currentDialogue != null) {
                 inputQueue.Add(currentDialogue);
             }
+            if (listenPause != null) {
+                inputQueue.Add(listenPause);
+            }
         }
     }
 }
@@ -1,6 +1,7 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.Globalization;
 using System.Speech.Recognition;
 using System.Text.RegularExpressions;
 
@@ -11,38 +12,51 @@ namespace DSN {
 
         private Configuration config;
 
-        public static DialogueList Parse(string input, Configuration config) {
+        // input: <id>|<hash>|<line>|<hash>|<line>... the hash of each line (16 hex digits) is the key of its grammar in `grammarCache`
+        public static DialogueList Parse(string input, Configuration config, GrammarCache grammarCache) {
             string[] tokens = input.Split('|');
             long id = long.Parse(tokens[0]);
+            List<ulong> lineHashes = new List<ulong>();
             List<string> lines = new List<string>();
-            for(int i = 1; i < tokens.Length; i++) {
-                lines.Add(Phrases.normalize(tokens[i]));
+            for(int i = 1; i + 1 < tokens.Length; i += 2) {
+                ulong lineHash;
+                if (!ulong.TryParse(tokens[i], NumberStyles.AllowHexSpecifier, CultureInfo.InvariantCulture, out lineHash)) {
+                    Trace.TraceError("Malformed hash '{0}' for dialogue line {1}, its grammar will not be cached", tokens[i], tokens[i + 1]);
+                    lineHash = 0;
+                }
+                lineHashes.Add(lineHash);
+                lines.Add(tokens[i + 1]);
             }
-            return new DialogueList(id, lines, config);
+            return new DialogueList(id, lineHashes, lines, config, grammarCache);
         }
 
         public long id { get; private set; }
         private Dictionary<Grammar, int> grammarToIndex = new Dictionary<Grammar, int>();
 
-        private DialogueList(long id, List<string> lines, Configuration config) {
+        private DialogueList(long id, List<ulong> lineHashes, List<string> lines, Configuration config, GrammarCache grammarCache) {
             this.id = id;
             this.config = config;
 
             SubsetMatchingMode matchingMode = getConfiguredMatchingMode();
             List<string> goodbyePhrases = config.GetGoodbyePhrases();
 
+            Stopwatch watch = Stopwatch.StartNew();
+            long missesBefore = grammarCache.Misses;
             for (int i = 0; i < lines.Count; i++) {
-                string line = lines[i];
-                if (line == null || line.Trim() == "")
-                    continue;
-                try {
-                    Grammar g = new Grammar(new GrammarBuilder(line, matchingMode));
-                    grammarToIndex[g] = i;
+                Grammar g;
+                if (lineHashes[i] != 0) {
+                    g = grammarCache.GetOrBuild(lineHashes[i], lines[i], matchingMode);
+                } else {
+                    bool failed;
+                    g = GrammarCache.Build(lines[i], matchingMode, out failed);
                 }
-                catch(Exception ex) {
-                    Trace.TraceError("Failed to create grammar for line {0} due to exception:\n{1}", line, ex.ToString());
+                // A line offered twice shares its grammar, the first topic is selected
+                if (g != null && !grammarToIndex.ContainsKey(g)) {
+                    grammarToIndex[g] = i;
                 }
             }
+            Trace.TraceInformation("Dialogue {0}: {1} grammars built for {2} lines in {3} ms (grammar cache: {4} cached, hit rate {5:P1})",
+                id, grammarCache.Misses - missesBefore, lines.Count, watch.ElapsedMilliseconds, grammarCache.Count, grammarCache.HitRate);
 
             foreach(string phrase in goodbyePhrases) {
                 if (phrase == null || phrase.Trim() == "")
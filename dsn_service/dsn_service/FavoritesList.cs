@@ -13,6 +13,10 @@ namespace DSN {
 
         private Configuration config;
         private Dictionary<Grammar, string> commandsByGrammar;
+        // Grammars by phrase and handedness, the grammars of the previous update are reused for unchanged items
+        // so that SpeechRecognitionManager does not load them again
+        private Dictionary<string, Grammar> grammarsByPhrase = new Dictionary<string, Grammar>();
+        private Dictionary<string, Grammar> previousGrammarsByPhrase = new Dictionary<string, Grammar>();
 
         private bool enabled;
         private bool useEquipHandPrefix;
@@ -86,6 +90,14 @@ namespace DSN {
 
         public void BuildAndAddGrammar(string phrase, string command, bool isSingleHanded)
         {
+            string key = (isSingleHanded ? "1|" : "0|") + phrase;
+            Grammar grammar;
+            if (grammarsByPhrase.TryGetValue(key, out grammar) || previousGrammarsByPhrase.TryGetValue(key, out grammar)) {
+                grammarsByPhrase[key] = grammar;
+                commandsByGrammar[grammar] = command;
+                return;
+            }
+
             Choices handChoice = new Choices(new string[] { bothHandsSuffix, leftHandSuffix, rightHandSuffix });
             GrammarBuilder grammarBuilder = new GrammarBuilder();
 
@@ -105,8 +117,9 @@ namespace DSN {
                 grammarBuilder.Append(handChoice, 0, 1);
             }
 
-            Grammar grammar = new Grammar(grammarBuilder);
+            grammar = new Grammar(grammarBuilder);
             grammar.Name = phrase;
+            grammarsByPhrase[key] = grammar;
             commandsByGrammar[grammar] = command;
         }
 
@@ -158,6 +171,8 @@ namespace DSN {
 
             string equipPrefix = config.Get("Favorites", "equipPhrasePrefix", "equip");
             commandsByGrammar.Clear();
+            previousGrammarsByPhrase = grammarsByPhrase;
+            grammarsByPhrase = new Dictionary<string, Grammar>();
             string[] itemTokens = input.Split('|');
             foreach(string itemStr in itemTokens) {
                 try
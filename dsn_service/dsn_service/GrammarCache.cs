@@ -0,0 +1,113 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Speech.Recognition;
+
+namespace DSN {
+    // LRU cache of the dialogue line grammars, keyed by the hash of the line sent by the plugin and the matching mode.
+    // NPCs often offer the same topics again, their grammars are reused instead of built again.
+    // Not thread-safe, used by the thread reading the input of Skyrim.
+    class GrammarCache {
+
+        private struct CacheKey : IEquatable<CacheKey> {
+            public ulong lineHash;
+            public SubsetMatchingMode matchingMode;
+
+            public bool Equals(CacheKey other) {
+                return lineHash == other.lineHash && matchingMode == other.matchingMode;
+            }
+
+            public override bool Equals(object obj) {
+                return obj is CacheKey && Equals((CacheKey)obj);
+            }
+
+            public override int GetHashCode() {
+                return lineHash.GetHashCode() ^ (int)matchingMode;
+            }
+        }
+
+        private class CacheEntry {
+            public CacheKey key;
+            public Grammar grammar; // null when the normalized line is empty
+        }
+
+        private readonly int capacity;
+        private Dictionary<CacheKey, LinkedListNode<CacheEntry>> entries = new Dictionary<CacheKey, LinkedListNode<CacheEntry>>();
+        private LinkedList<CacheEntry> recentlyUsed = new LinkedList<CacheEntry>(); // most recently used first
+
+        private long hits = 0;
+        private long misses = 0;
+
+        public GrammarCache(int capacity) {
+            this.capacity = Math.Max(capacity, 1);
+        }
+
+        public int Count {
+            get { return entries.Count; }
+        }
+
+        // Returns the grammar of the dialogue line, building it when it is not cached.
+        // Returns null if the line is empty once normalized or its grammar cannot be built.
+        public Grammar GetOrBuild(ulong lineHash, string line, SubsetMatchingMode matchingMode) {
+            CacheKey key = new CacheKey { lineHash = lineHash, matchingMode = matchingMode };
+
+            LinkedListNode<CacheEntry> node;
+            if (entries.TryGetValue(key, out node)) {
+                hits++;
+                recentlyUsed.Remove(node);
+                recentlyUsed.AddFirst(node);
+                return node.Value.grammar;
+            }
+
+            misses++;
+            bool failed;
+            Grammar grammar = Build(line, matchingMode, out failed);
+            if (failed) {
+                return null;
+            }
+
+            if (entries.Count >= capacity) {
+                LinkedListNode<CacheEntry> oldest = recentlyUsed.Last;
+                recentlyUsed.RemoveLast();
+                entries.Remove(oldest.Value.key);
+            }
+            node = recentlyUsed.AddFirst(new CacheEntry { key = key, grammar = grammar });
+            entries[key] = node;
+            return grammar;
+        }
+
+        // Build the grammar of a dialogue line without caching it, null if the normalized line is empty.
+        // `failed` is set when the grammar cannot be built.
+        public static Grammar Build(string line, SubsetMatchingMode matchingMode, out bool failed) {
+            failed = false;
+            string phrase = Phrases.normalize(line);
+            if (phrase.Trim() == "") {
+                return null;
+            }
+            try {
+                return new Grammar(new GrammarBuilder(phrase, matchingMode));
+            } catch (Exception ex) {
+                Trace.TraceError("Failed to create grammar for line {0} due to exception:\n{1}", phrase, ex.ToString());
+                failed = true;
+                return null;
+            }
+        }
+
+        // Lookups that found the grammar in the cache since it was created
+        public long Hits {
+            get { return hits; }
+        }
+
+        // Lookups that built the grammar since the cache was created
+        public long Misses {
+            get { return misses; }
+        }
+
+        public double HitRate {
+            get {
+                long lookups = hits + misses;
+                return lookups == 0 ? 0 : (double)hits / lookups;
+            }
+        }
+    }
+}
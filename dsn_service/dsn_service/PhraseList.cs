@@ -0,0 +1,95 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Speech.Recognition;
+using System.Text;
+
+namespace DSN {
+    // Phrases registered by other Skyrim plugins through the C API of the plugin (REGISTER_PHRASES),
+    // recognized in command mode and reported to Skyrim with PHRASE|<id>
+    class PhraseList : ISpeechRecognitionGrammarProvider {
+
+        private System.Object phrasesLock = new System.Object();
+        private Dictionary<int, Grammar> grammarsById = new Dictionary<int, Grammar>();
+        private Dictionary<Grammar, int> idsByGrammar = new Dictionary<Grammar, int>();
+
+        // REGISTER_PHRASES|<id>|<phrase>|<id>|<phrase>...
+        public void Register(string[] tokens) {
+            lock (phrasesLock) {
+                for (int i = 1; i + 1 < tokens.Length; i += 2) {
+                    int id;
+                    string phrase = tokens[i + 1].Trim();
+                    if (!int.TryParse(tokens[i], out id) || phrase.Length == 0) {
+                        Trace.TraceError("Invalid phrase registration '{0}|{1}'", tokens[i], tokens[i + 1]);
+                        continue;
+                    }
+
+                    try {
+                        Grammar grammar = new Grammar(new GrammarBuilder(phrase));
+                        grammar.Name = phrase;
+                        Remove(id);
+                        grammarsById[id] = grammar;
+                        idsByGrammar[grammar] = id;
+                    } catch (Exception ex) {
+                        Trace.TraceError("Failed to build the grammar of registered phrase '{0}':", phrase);
+                        Trace.TraceError(ex.ToString());
+                    }
+                }
+                Trace.TraceInformation("{0} phrases registered by other plugins", grammarsById.Count);
+            }
+        }
+
+        // UNREGISTER_PHRASES|<id>|<id>...
+        public void Unregister(string[] tokens) {
+            lock (phrasesLock) {
+                for (int i = 1; i < tokens.Length; i++) {
+                    int id;
+                    if (int.TryParse(tokens[i], out id)) {
+                        Remove(id);
+                    }
+                }
+                Trace.TraceInformation("{0} phrases registered by other plugins", grammarsById.Count);
+            }
+        }
+
+        private void Remove(int id) {
+            Grammar grammar;
+            if (grammarsById.TryGetValue(id, out grammar)) {
+                grammarsById.Remove(id);
+                idsByGrammar.Remove(grammar);
+            }
+        }
+
+        // Returns the id of a registered phrase, or -1
+        public int GetIdForPhrase(Grammar grammar) {
+            lock (phrasesLock) {
+                int id;
+                if (idsByGrammar.TryGetValue(grammar, out id))
+                    return id;
+                return -1;
+            }
+        }
+
+        // One REGISTER_PHRASES line with every registered phrase, null if there are none.
+        // Saved to restore the phrases after reloading the configuration file.
+        public string GetRegisterPhrasesMessage() {
+            lock (phrasesLock) {
+                if (grammarsById.Count == 0)
+                    return null;
+
+                StringBuilder message = new StringBuilder("REGISTER_PHRASES");
+                foreach (KeyValuePair<int, Grammar> entry in grammarsById) {
+                    message.Append('|').Append(entry.Key).Append('|').Append(entry.Value.Name);
+                }
+                return message.ToString();
+            }
+        }
+
+        public List<Grammar> GetGrammars() {
+            lock (phrasesLock) {
+                return grammarsById.Values.ToList();
+            }
+        }
+    }
+}
@@ -27,6 +27,16 @@ namespace DSN {
                     }
                 }
 
+                // The plugin can ask for the shared memory transport, the console is redirected to it.
+                // After the encoding is set, which resets the console streams.
+                for (int i = 0; i + 1 < args.Length; i++)
+                {
+                    if (args[i].Equals("--shared-memory") && !SharedMemoryTransport.Attach(args[i + 1]))
+                    {
+                        Trace.TraceInformation("Using stdin/stdout instead of the shared memory region {0}", args[i + 1]);
+                    }
+                }
+
                 // Thread.Abort() cannot abort the calling of Console.ReadLine().
                 // So the call is in a separate thread that does not need to be restarted
                 // after reloading the configuration file.
@@ -36,8 +46,9 @@ namespace DSN {
                 bool reloadConfigFile = true;
                 while (reloadConfigFile)
                 {
+                    Stopwatch startupTimer = Stopwatch.StartNew();
                     Configuration config = new Configuration();
-                    SkyrimInterop skyrimInterop = new SkyrimInterop(config, consoleInput);
+                    SkyrimInterop skyrimInterop = new SkyrimInterop(config, consoleInput, startupTimer);
                     ExternalInterop externalInterop = new ExternalInterop(config, skyrimInterop);
 
                     skyrimInterop.Start();
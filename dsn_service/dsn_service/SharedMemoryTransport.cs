@@ -0,0 +1,289 @@
+﻿using System;
+using System.Diagnostics;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading;
+
+namespace DSN {
+    // Shared memory transport with the plugin (see dsn_plugin/dsn_core/SharedMemoryPipe.h for the layout).
+    // When the plugin launches the service with "--shared-memory <name>", Console.In and Console.Out
+    // are redirected to the rings of the region, the rest of the service keeps using the console.
+    unsafe class SharedMemoryTransport {
+
+        private const uint MAGIC = 0x524E5344;
+        private const uint VERSION = 1;
+        private const int HEADER_SIZE = 576;
+
+        // Fields of the header
+        private const int MAGIC_OFFSET = 0;
+        private const int VERSION_OFFSET = 4;
+        private const int CAPACITY_OFFSET = 8;
+        private const int PLUGIN_PROCESS_ID_OFFSET = 12;
+        private const int ATTACH_STATE_OFFSET = 16;
+        private const int PLUGIN_CLOSED_OFFSET = 20;
+        private const int SERVICE_CLOSED_OFFSET = 24;
+        private const int RINGS_OFFSET = 64;
+        private const int RING_CONTROL_SIZE = 256;
+
+        // Fields of a ring control
+        private const int HEAD_OFFSET = 0;
+        private const int TAIL_OFFSET = 64;
+        private const int DATA_SEQUENCE_OFFSET = 128;
+        private const int READER_WAITING_OFFSET = 132;
+        private const int SPACE_SEQUENCE_OFFSET = 192;
+        private const int WRITER_WAITING_OFFSET = 196;
+
+        private const int RING_TO_SERVICE = 0;
+        private const int RING_TO_PLUGIN = 1;
+        private const int ATTACH_WAITING = 0;
+        private const int ATTACH_SERVICE = 1;
+
+        // Waits are cut into slices to check the plugin, a reader yields a few times before it sleeps
+        private const int WAIT_SLICE = 100;
+        private const int SPIN_COUNT = 64;
+
+        // Kept alive with the redirected console
+        private static SharedMemoryTransport current = null;
+
+        private MemoryMappedFile mapping;
+        private MemoryMappedViewAccessor view;
+        private byte* region = null;
+        private int capacity;
+        private EventWaitHandle[] signals = new EventWaitHandle[4];
+        private Process plugin = null;
+        private bool closed = false;
+
+        // Redirect the console to the region `name`. Returns false if the console must be used,
+        // e.g. when the plugin stopped waiting for the service.
+        public static bool Attach(string name) {
+            SharedMemoryTransport transport = new SharedMemoryTransport();
+            try {
+                if (!transport.Open(name)) {
+                    transport.Dispose();
+                    return false;
+                }
+            } catch (Exception ex) {
+                Trace.TraceError("Failed to open the shared memory region {0}:", name);
+                Trace.TraceError(ex.ToString());
+                transport.Dispose();
+                return false;
+            }
+
+            current = transport;
+            // Same encodings as the console, without the BOM a StreamWriter would write first
+            Encoding outputEncoding = Console.OutputEncoding;
+            if (outputEncoding.CodePage == Encoding.UTF8.CodePage) {
+                outputEncoding = new UTF8Encoding(false);
+            }
+            Console.SetIn(new StreamReader(new RingReader(transport), Console.InputEncoding));
+            StreamWriter writer = new StreamWriter(new RingWriter(transport), outputEncoding);
+            writer.AutoFlush = true;
+            Console.SetOut(writer);
+            AppDomain.CurrentDomain.ProcessExit += (sender, e) => transport.Close();
+
+            Trace.TraceInformation("Talking to Skyrim through the shared memory region {0}", name);
+            return true;
+        }
+
+        private bool Open(string name) {
+            mapping = MemoryMappedFile.OpenExisting(name);
+            view = mapping.CreateViewAccessor();
+            view.SafeMemoryMappedViewHandle.AcquirePointer(ref region);
+            region += view.PointerOffset;
+
+            capacity = *(int*)(region + CAPACITY_OFFSET);
+            if (*(uint*)(region + MAGIC_OFFSET) != MAGIC || *(uint*)(region + VERSION_OFFSET) != VERSION ||
+                capacity <= 0 || (capacity & (capacity - 1)) != 0 || view.Capacity < HEADER_SIZE + 2L * capacity) {
+                Trace.TraceError("The shared memory region {0} is not one of this version", name);
+                return false;
+            }
+            for (int i = 0; i < signals.Length; i++) {
+                signals[i] = EventWaitHandle.OpenExisting(name + "." + i);
+            }
+            try {
+                plugin = Process.GetProcessById(*(int*)(region + PLUGIN_PROCESS_ID_OFFSET));
+            } catch (ArgumentException) {
+                return false;
+            }
+
+            // The plugin may have stopped waiting, then it reads our stdout
+            return Interlocked.CompareExchange(ref *(int*)(region + ATTACH_STATE_OFFSET), ATTACH_SERVICE, ATTACH_WAITING) == ATTACH_WAITING;
+        }
+
+        private void Dispose() {
+            if (region != null) {
+                view.SafeMemoryMappedViewHandle.ReleasePointer();
+                region = null;
+            }
+            if (view != null) {
+                view.Dispose();
+            }
+            if (mapping != null) {
+                mapping.Dispose();
+            }
+        }
+
+        // Tell the plugin nothing more will be written
+        private void Close() {
+            if (closed) {
+                return;
+            }
+            closed = true;
+            Volatile.Write(ref *(int*)(region + SERVICE_CLOSED_OFFSET), 1);
+            byte* ring = Ring(RING_TO_PLUGIN);
+            Interlocked.Increment(ref *(int*)(ring + DATA_SEQUENCE_OFFSET));
+            signals[2].Set();
+        }
+
+        private byte* Ring(int ring) {
+            return region + RINGS_OFFSET + ring * RING_CONTROL_SIZE;
+        }
+
+        private byte* Data(int ring) {
+            return region + HEADER_SIZE + (long)ring * capacity;
+        }
+
+        private bool IsPluginClosed() {
+            return Volatile.Read(ref *(int*)(region + PLUGIN_CLOSED_OFFSET)) != 0;
+        }
+
+        private bool IsPluginGone() {
+            return plugin.HasExited;
+        }
+
+        // Blocks until data is available, returns 0 at the end of the stream
+        private int Read(byte[] buffer, int offset, int count) {
+            byte* ring = Ring(RING_TO_SERVICE);
+            byte* data = Data(RING_TO_SERVICE);
+            bool checkPlugin = false;
+            int spins = 0;
+
+            while (true) {
+                long tail = Volatile.Read(ref *(long*)(ring + TAIL_OFFSET));
+                long head = Volatile.Read(ref *(long*)(ring + HEAD_OFFSET));
+                if (head != tail) {
+                    int length = (int)Math.Min(count, head - tail);
+                    int position = (int)(tail & (capacity - 1));
+                    int first = Math.Min(length, capacity - position);
+                    Marshal.Copy((IntPtr)(data + position), buffer, offset, first);
+                    Marshal.Copy((IntPtr)data, buffer, offset + first, length - first);
+                    Volatile.Write(ref *(long*)(ring + TAIL_OFFSET), tail + length);
+
+                    Interlocked.Increment(ref *(int*)(ring + SPACE_SEQUENCE_OFFSET));
+                    if (Volatile.Read(ref *(int*)(ring + WRITER_WAITING_OFFSET)) != 0) {
+                        signals[1].Set();
+                    }
+                    return length;
+                }
+
+                // The data written before the plugin closed is read first
+                if ((IsPluginClosed() || (checkPlugin && IsPluginGone())) && Volatile.Read(ref *(long*)(ring + HEAD_OFFSET)) == tail) {
+                    return 0;
+                }
+
+                if (spins < SPIN_COUNT) {
+                    spins++;
+                    Thread.Yield();
+                    continue;
+                }
+                spins = 0;
+
+                Interlocked.Exchange(ref *(int*)(ring + READER_WAITING_OFFSET), 1);
+                if (Volatile.Read(ref *(long*)(ring + HEAD_OFFSET)) == tail && !IsPluginClosed()) {
+                    signals[0].WaitOne(WAIT_SLICE);
+                }
+                Volatile.Write(ref *(int*)(ring + READER_WAITING_OFFSET), 0);
+                checkPlugin = true;
+            }
+        }
+
+        // Blocks while the ring is full, throws once the plugin is gone
+        private void Write(byte[] buffer, int offset, int count) {
+            byte* ring = Ring(RING_TO_PLUGIN);
+            byte* data = Data(RING_TO_PLUGIN);
+
+            while (count > 0) {
+                if (closed) {
+                    throw new IOException("The shared memory transport is closed");
+                }
+
+                long head = Volatile.Read(ref *(long*)(ring + HEAD_OFFSET));
+                long tail = Volatile.Read(ref *(long*)(ring + TAIL_OFFSET));
+                int space = (int)(capacity - (head - tail));
+                if (space == 0) {
+                    if (IsPluginGone()) {
+                        throw new IOException("Skyrim is terminated");
+                    }
+                    Interlocked.Exchange(ref *(int*)(ring + WRITER_WAITING_OFFSET), 1);
+                    if (Volatile.Read(ref *(long*)(ring + TAIL_OFFSET)) == tail) {
+                        signals[3].WaitOne(WAIT_SLICE);
+                    }
+                    Volatile.Write(ref *(int*)(ring + WRITER_WAITING_OFFSET), 0);
+                    continue;
+                }
+
+                int length = Math.Min(space, count);
+                int position = (int)(head & (capacity - 1));
+                int first = Math.Min(length, capacity - position);
+                Marshal.Copy(buffer, offset, (IntPtr)(data + position), first);
+                Marshal.Copy(buffer, offset + first, (IntPtr)data, length - first);
+                Volatile.Write(ref *(long*)(ring + HEAD_OFFSET), head + length);
+
+                Interlocked.Increment(ref *(int*)(ring + DATA_SEQUENCE_OFFSET));
+                if (Volatile.Read(ref *(int*)(ring + READER_WAITING_OFFSET)) != 0) {
+                    signals[2].Set();
+                }
+                offset += length;
+                count -= length;
+            }
+        }
+
+        // Read-only stream on the plugin -> service ring
+        private class RingReader : Stream {
+            private SharedMemoryTransport transport;
+
+            public RingReader(SharedMemoryTransport transport) {
+                this.transport = transport;
+            }
+
+            public override int Read(byte[] buffer, int offset, int count) {
+                return transport.Read(buffer, offset, count);
+            }
+
+            public override bool CanRead { get { return true; } }
+            public override bool CanSeek { get { return false; } }
+            public override bool CanWrite { get { return false; } }
+            public override long Length { get { throw new NotSupportedException(); } }
+            public override long Position { get { throw new NotSupportedException(); } set { throw new NotSupportedException(); } }
+            public override void Flush() { }
+            public override long Seek(long offset, SeekOrigin origin) { throw new NotSupportedException(); }
+            public override void SetLength(long value) { throw new NotSupportedException(); }
+            public override void Write(byte[] buffer, int offset, int count) { throw new NotSupportedException(); }
+        }
+
+        // Write-only stream on the service -> plugin ring
+        private class RingWriter : Stream {
+            private SharedMemoryTransport transport;
+
+            public RingWriter(SharedMemoryTransport transport) {
+                this.transport = transport;
+            }
+
+            public override void Write(byte[] buffer, int offset, int count) {
+                transport.Write(buffer, offset, count);
+            }
+
+            public override bool CanRead { get { return false; } }
+            public override bool CanSeek { get { return false; } }
+            public override bool CanWrite { get { return true; } }
+            public override long Length { get { throw new NotSupportedException(); } }
+            public override long Position { get { throw new NotSupportedException(); } set { throw new NotSupportedException(); } }
+            public override void Flush() { }
+            public override int Read(byte[] buffer, int offset, int count) { throw new NotSupportedException(); }
+            public override long Seek(long offset, SeekOrigin origin) { throw new NotSupportedException(); }
+            public override void SetLength(long value) { throw new NotSupportedException(); }
+        }
+    }
+}
@@ -2,6 +2,7 @@
 using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.Globalization;
 using System.Linq;
 using System.Speech.Recognition;
 using System.Text;
@@ -13,29 +14,76 @@ namespace DSN {
 
         private Configuration config = null;
         private ConsoleInput consoleInput = null;
+        private Stopwatch startupTimer = null;
+        private int pendingStartupStages = 2; // grammars and device
 
         private System.Object dialogueLock = new System.Object();
         private DialogueList currentDialogue = null;
         private FavoritesList favoritesList = null;
+        private PhraseList phraseList = new PhraseList();
+        private GrammarCache dialogueGrammarCache = null;
+        private const int DEFAULT_DIALOGUE_GRAMMAR_CACHE_SIZE = 512;
         private SpeechRecognitionManager recognizer;
         private Thread submissionThread;
         private Thread listenThread;
-        private BlockingCollection<string> commandQueue;
 
-        public SkyrimInterop(Configuration config, ConsoleInput consoleInput) {
+        // Lanes of the lines sent to Skyrim, by priority: a dialogue topic selection
+        // is never sent after an equip or a console command that was recognized before it
+        private const int LANE_DIALOGUE = 0; // also READY
+        private const int LANE_EQUIP = 1;
+        private const int LANE_COMMAND = 2;
+        private static readonly string[] LANE_NAMES = { "dialogue", "equip", "command" };
+        private BlockingCollection<QueuedLine>[] lanes;
+
+        private class QueuedLine {
+            public string line;
+            public long queuedAt;
+            public int deadline = -1; // COMMAND lines: the deadline and the age of the commands are added when sending
+        }
+
+        // startupTimer was started before loading the configuration, the startup stages are reported relative to it
+        public SkyrimInterop(Configuration config, ConsoleInput consoleInput, Stopwatch startupTimer) {
             this.config = config;
             this.consoleInput = consoleInput;
+            this.startupTimer = startupTimer;
         }
 
         public void Start() {
             try {
+                lanes = new BlockingCollection<QueuedLine>[LANE_NAMES.Length];
+                for (int i = 0; i < lanes.Length; i++) {
+                    lanes[i] = new BlockingCollection<QueuedLine>();
+                }
+                ReportStartupStage("config");
+
+                // Build the command grammars while the recognition engine is created and the recording device acquired
+                Task<CommandList> grammarPreload = Task.Run(() => {
+                    Stopwatch watch = Stopwatch.StartNew();
+                    CommandList commands = config.GetConsoleCommandList();
+                    Trace.TraceInformation("Built {0} command grammars in {1} ms", commands.commandsByPhrase.Count, watch.ElapsedMilliseconds);
+                    // On the command lane before any recognized command, which are sent by id
+                    SubmitCommand(commands.GetRegisterCommandsMessage());
+                    ReportStartupStage("grammars");
+                    return commands;
+                });
+
                 favoritesList = new FavoritesList(config);
-                commandQueue = new BlockingCollection<string>();
+                string cacheSizeValue = config.Get("SpeechRecognition", "dialogueGrammarCacheSize", DEFAULT_DIALOGUE_GRAMMAR_CACHE_SIZE.ToString());
+                int cacheSize;
+                if (!int.TryParse(cacheSizeValue, out cacheSize) || cacheSize <= 0) {
+                    Trace.TraceError("Invalid dialogueGrammarCacheSize '{0}', using {1}", cacheSizeValue, DEFAULT_DIALOGUE_GRAMMAR_CACHE_SIZE);
+                    cacheSize = DEFAULT_DIALOGUE_GRAMMAR_CACHE_SIZE;
+                }
+                dialogueGrammarCache = new GrammarCache(cacheSize);
                 recognizer = new SpeechRecognitionManager(config);
                 recognizer.OnDialogueLineRecognized += Recognizer_OnDialogueLineRecognized;
+                recognizer.OnRecordingDeviceReady += Recognizer_OnRecordingDeviceReady;
+                ReportStartupStage("engine");
+
+                recognizer.Start();
 
                 // Start in command-mode
-                recognizer.StartSpeechRecognition(false, config.GetConsoleCommandList(), favoritesList);
+                recognizer.StartSpeechRecognition(false, grammarPreload.Result, favoritesList, phraseList);
 
                 listenThread = new Thread(ListenForInput);
                 submissionThread = new Thread(SubmitCommands);
@@ -55,13 +103,43 @@ namespace DSN {
         public void Stop() {
             // Notify threads to exit
             consoleInput.WriteLine(null);
-            commandQueue.Add(null);
+            lanes[LANE_DIALOGUE].Add(new QueuedLine());
             
             recognizer.Stop();
         }
 
+        // Log the time a startup stage took to complete and report it to Skyrim: READY|<stage>|<ms>
+        private void ReportStartupStage(string stage) {
+            long elapsed = startupTimer.ElapsedMilliseconds;
+            Trace.TraceInformation("Startup stage '{0}' ready after {1} ms", stage, elapsed);
+            SubmitCommand("READY|" + stage + "|" + elapsed);
+
+            if ((stage == "grammars" || stage == "device") && Interlocked.Decrement(ref pendingStartupStages) == 0) {
+                Trace.TraceInformation("Speech recognition service ready after {0} ms", elapsed);
+                SubmitCommand("READY|all|" + elapsed);
+            }
+        }
+
+        private void Recognizer_OnRecordingDeviceReady() {
+            ReportStartupStage("device");
+        }
+
         public void SubmitCommand(string command) {
-            commandQueue.Add(sanitize(command));
+            command = sanitize(command);
+            int lane = LANE_DIALOGUE;
+            if (command.StartsWith("EQUIP|")) {
+                lane = LANE_EQUIP;
+            } else if (command.StartsWith("COMMAND|") || command.StartsWith("REGISTER_COMMANDS|") || command.StartsWith("PHRASE|") || command.StartsWith("PAPYRUS_EVENT|")) {
+                lane = LANE_COMMAND;
+            }
+            lanes[lane].Add(new QueuedLine { line = command, queuedAt = startupTimer.ElapsedMilliseconds });
+        }
+
+        // Queue the commands of a recognized phrase, they are dropped by Skyrim `deadline` ms after now (0 for never).
+        // Registered commands are sent by id (see CommandList.GetCommandIdForPhrase).
+        private void SubmitRecognizedCommand(string command, int commandId, int deadline) {
+            string line = commandId >= 0 ? "COMMAND_ID|" + commandId : "COMMAND|" + sanitize(command);
+            lanes[LANE_COMMAND].Add(new QueuedLine { line = line, queuedAt = startupTimer.ElapsedMilliseconds, deadline = deadline });
         }
 
         private static string sanitize(string command) {
@@ -71,15 +149,23 @@ namespace DSN {
 
         private void SubmitCommands() {
             while(true) {
-                string command = commandQueue.Take();
+                // TakeFromAny() tries the lanes in order, so the first non-empty lane is taken
+                QueuedLine queued;
+                int lane = BlockingCollection<QueuedLine>.TakeFromAny(lanes, out queued);
 
                 // Thread exit signal
-                if (command == null) {
+                if (queued.line == null) {
                     break;
                 }
 
-                Trace.TraceInformation("Sending command: {0}", command);
-                Console.Write(command+"\n");
+                long waited = startupTimer.ElapsedMilliseconds - queued.queuedAt;
+                string line = queued.line;
+                if (queued.deadline >= 0) {
+                    line += "|" + queued.deadline + "|" + waited;
+                }
+
+                Trace.TraceInformation("Sending command: {0} ({1} lane, queued for {2} ms)", line, LANE_NAMES[lane], waited);
+                Console.Write(line+"\n");
             }
         }
 
@@ -103,28 +189,45 @@ namespace DSN {
                     if (command.Equals("START_DIALOGUE")) {
                         consoleInput.currentDialogue = input;
                         lock (dialogueLock) {
-                            currentDialogue = DialogueList.Parse(string.Join("|", tokens, 1, tokens.Length - 1), config);
+                            currentDialogue = DialogueList.Parse(string.Join("|", tokens, 1, tokens.Length - 1), config, dialogueGrammarCache);
                         }
                         // Switch to dialogue mode
                         recognizer.StartSpeechRecognition(true, currentDialogue);
                     } else if (command.Equals("STOP_DIALOGUE")) {
                         consoleInput.currentDialogue = null;
                         // Switch to command mode
-                        recognizer.StartSpeechRecognition(false, config.GetConsoleCommandList(), favoritesList);
+                        recognizer.StartSpeechRecognition(false, config.GetConsoleCommandList(), favoritesList, phraseList);
                         lock (dialogueLock) {
                             currentDialogue = null;
                         }
+                    } else if (command.Equals("REGISTER_PHRASES") || command.Equals("UNREGISTER_PHRASES")) {
+                        if (command.Equals("REGISTER_PHRASES")) {
+                            phraseList.Register(tokens);
+                        } else {
+                            phraseList.Unregister(tokens);
+                        }
+                        consoleInput.registeredPhrases = phraseList.GetRegisterPhrasesMessage();
+                        if (currentDialogue == null) {
+                            recognizer.StartSpeechRecognition(false, config.GetConsoleCommandList(), favoritesList, phraseList);
+                        }
+                    } else if (command.Equals("LISTEN_PAUSE")) {
+                        consoleInput.listenPause = input;
+                        recognizer.Pause(tokens.Length > 1 ? tokens[1] : "");
+                    } else if (command.Equals("LISTEN_RESUME")) {
+                        consoleInput.listenPause = null;
+                        recognizer.Resume();
                     } else if (command.Equals("FAVORITES")) {
                         consoleInput.currentFavoritesList = input;
                         favoritesList.Update(string.Join("|", tokens, 1, tokens.Length - 1));
                         if(currentDialogue == null) {
-                            recognizer.StartSpeechRecognition(false, config.GetConsoleCommandList(), favoritesList);
+                            recognizer.StartSpeechRecognition(false, config.GetConsoleCommandList(), favoritesList, phraseList);
                         }
                     }
                 }
             } catch (Exception ex) {
                 Trace.TraceError(ex.ToString());
             }
+            recognizer.LogModeSwitchSummary();
         }
 
         private void Recognizer_OnDialogueLineRecognized(RecognitionResult result) {
@@ -140,9 +243,20 @@ namespace DSN {
                     if(command != null) {
                         SubmitCommand("EQUIP|" + command);
                     } else {
-                        command = config.GetConsoleCommandList().GetCommandForPhrase(result.Grammar);
+                        CommandList commands = config.GetConsoleCommandList();
+                        command = commands.GetCommandForPhrase(result.Grammar);
                         if (command != null) {
-                            SubmitCommand("COMMAND|" + command);
+                            SubmitRecognizedCommand(command, commands.GetCommandIdForPhrase(result.Grammar), commands.GetDeadlineForPhrase(result.Grammar));
+                            // After the commands, on the same lane
+                            int? papyrusEvent = commands.GetPapyrusEventForPhrase(result.Grammar);
+                            if (papyrusEvent.HasValue) {
+                                SubmitCommand("PAPYRUS_EVENT|" + papyrusEvent.Value + "|" + result.Confidence.ToString("0.000", CultureInfo.InvariantCulture) + "|" + result.Grammar.Name);
+                            }
+                        } else {
+                            int phraseId = phraseList.GetIdForPhrase(result.Grammar);
+                            if (phraseId >= 0) {
+                                SubmitCommand("PHRASE|" + phraseId);
+                            }
                         }
                     }
                 }
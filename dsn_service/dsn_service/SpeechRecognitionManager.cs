@@ -13,9 +13,16 @@ namespace DSN {
         private const long STATUS_RECOGNIZING    = 1; // in recognizing
         private const long STATUS_WAITING_DEVICE = 2; // waiting for record device
 
+        // How grammars are switched between command and dialogue mode ([SpeechRecognition] grammarSwitchMode)
+        private const string GRAMMAR_SWITCH_RELOAD = "reload"; // stop recognition, unload the unused grammars and load the new ones
+        private const string GRAMMAR_SWITCH_TOGGLE = "toggle"; // keep the grammars of both modes loaded and enable/disable them
+
         public delegate void DialogueLineRecognitionHandler(RecognitionResult result);
         public event DialogueLineRecognitionHandler OnDialogueLineRecognized;
 
+        public delegate void RecordingDeviceReadyHandler();
+        public event RecordingDeviceReadyHandler OnRecordingDeviceReady;
+
         private long recognitionStatus = STATUS_STOPPED; // Need thread safety.
         private readonly SpeechRecognitionEngine DSN;    // Need thread safety.
         private float dialogueMinimumConfidence = 0.5f;  // Dialogue can be more generous in the min confidence because phrases are usually longer and more distinct amongst themselves
@@ -23,6 +30,29 @@ namespace DSN {
         private bool isDialogueMode = false;
         private ISpeechRecognitionGrammarProvider[] grammarProviders;
 
+        private bool toggleGrammars = false;
+        private HashSet<Grammar> loadedGrammars = new HashSet<Grammar>();
+        private List<Grammar> commandModeGrammars = new List<Grammar>();  // latest grammars of each mode
+        private List<Grammar> dialogueModeGrammars = new List<Grammar>();
+
+        // Measurement of the mode switch latency: from the switch until the grammars it loads are loaded
+        // (or the recognizer applied the enabled/disabled grammars when none is loaded)
+        private readonly object modeSwitchLock = new object();
+        private Stopwatch modeSwitchWatch = new Stopwatch();
+        private HashSet<Grammar> modeSwitchPendingLoads = new HashSet<Grammar>();
+        private object modeSwitchToken = null;
+        private string modeSwitchDescription = null; // null once the switch is reported
+        private int modeSwitchCount = 0;             // totals of the reported switches, see LogModeSwitchSummary()
+        private long modeSwitchTotalMilliseconds = 0;
+        private long modeSwitchMaxMilliseconds = 0;
+
+        // Paused by the plugin (LISTEN_PAUSE) in menus and outside push-to-talk: the recognition is stopped
+        // but the grammars stay loaded, so it starts again without reloading them
+        private volatile bool isPaused = false;
+        // CPU time used by the service since the last pause or resume, logged to compare listening and paused
+        private Stopwatch listenStateWatch = Stopwatch.StartNew();
+        private TimeSpan listenStateCpuTime = Process.GetCurrentProcess().TotalProcessorTime;
+
         private Thread waitingDeviceThread;
         private Configuration config;
 
@@ -33,7 +63,11 @@ namespace DSN {
             dialogueMinimumConfidence = float.Parse(config.Get("SpeechRecognition", "dialogueMinConfidence", "0.5"), CultureInfo.InvariantCulture);
             commandMinimumConfidence = float.Parse(config.Get("SpeechRecognition", "commandMinConfidence", "0.7"), CultureInfo.InvariantCulture);
 
-            Trace.TraceInformation("Locale: {0}\nDialogueConfidence: {1}\nCommandConfidence: {2}", locale, dialogueMinimumConfidence, commandMinimumConfidence);
+            string grammarSwitchMode = config.Get("SpeechRecognition", "grammarSwitchMode", GRAMMAR_SWITCH_RELOAD);
+            toggleGrammars = grammarSwitchMode.Equals(GRAMMAR_SWITCH_TOGGLE, StringComparison.OrdinalIgnoreCase);
+
+            Trace.TraceInformation("Locale: {0}\nDialogueConfidence: {1}\nCommandConfidence: {2}\nGrammarSwitchMode: {3}", locale, dialogueMinimumConfidence, commandMinimumConfidence,
+                toggleGrammars ? GRAMMAR_SWITCH_TOGGLE : GRAMMAR_SWITCH_RELOAD);
 
             this.DSN = new SpeechRecognitionEngine(new CultureInfo(locale));
             this.DSN.UpdateRecognizerSetting("CFGConfidenceRejectionThreshold", 10); // Range is 0-100
@@ -42,7 +76,12 @@ namespace DSN {
             this.DSN.AudioSignalProblemOccurred += DSN_AudioSignalProblemOccurred;
             this.DSN.SpeechRecognized += DSN_SpeechRecognized;
             this.DSN.SpeechRecognitionRejected += DSN_SpeechRecognitionRejected;
+            this.DSN.LoadGrammarCompleted += DSN_LoadGrammarCompleted;
+            this.DSN.RecognizerUpdateReached += DSN_RecognizerUpdateReached;
+        }
 
+        // Start acquiring the recording device, OnRecordingDeviceReady is raised when it is ready
+        public void Start() {
             WaitRecordingDeviceNonBlocking();
         }
 
@@ -85,6 +124,8 @@ namespace DSN {
                 // Thread-safe:recognitionStatus = STATUS_STOPPED
                 Interlocked.Exchange(ref recognitionStatus, STATUS_STOPPED);
 
+                OnRecordingDeviceReady?.Invoke();
+
                 // Restart recognition
                 if (grammarProviders != null && grammarProviders.Length > 0) {
                     StartSpeechRecognition(isDialogueMode, grammarProviders);
@@ -132,12 +173,22 @@ namespace DSN {
                 }
 
                 lock (DSN) {
+                    List<Grammar> allGrammars = grammarProviders.SelectMany((x) => x.GetGrammars()).ToList();
+
+                    // Switch without interrupting the recognition
+                    if (toggleGrammars && allGrammars.Count > 0 && (isPaused || Interlocked.Read(ref recognitionStatus) == STATUS_RECOGNIZING)) {
+                        ToggleGrammars(isDialogueMode, allGrammars);
+                        return;
+                    }
+
                     StopRecognition(); // Cancel previous recognition
 
-                    List<Grammar> allGrammars = grammarProviders.SelectMany((x) => x.GetGrammars()).ToList();
                     // Error is thrown if no grammars are loaded
                     if (allGrammars.Count > 0) {
-                        SetGrammar(allGrammars);
+                        SetGrammar(isDialogueMode, allGrammars);
+                        if (isPaused) {
+                            return; // started by Resume()
+                        }
                         this.DSN.RecognizeAsync(RecognizeMode.Multiple);
                         // Thread-safe: recognitionStatus = STATUS_RECOGNIZING
                         Interlocked.Exchange(ref recognitionStatus, STATUS_RECOGNIZING);
@@ -149,11 +200,164 @@ namespace DSN {
             }
         }
 
-        private void SetGrammar(List<Grammar> grammars) {
+        // Stop the recognition until Resume(), `reason` is logged
+        public void Pause(string reason) {
+            if (isPaused) {
+                return;
+            }
+            isPaused = true;
+            LogListenStateCpuTime("Listened");
+            Trace.TraceInformation("Recognition paused ({0})", reason);
+
+            // Thread-safe: if (recognitionStatus == STATUS_WAITING_DEVICE)
+            if (Interlocked.Read(ref recognitionStatus) == STATUS_WAITING_DEVICE) {
+                return; // not recognizing, the device thread holds the lock
+            }
+            lock (DSN) {
+                StopRecognition();
+            }
+        }
+
+        // Start the recognition again with the loaded grammars
+        public void Resume() {
+            if (!isPaused) {
+                return;
+            }
+            isPaused = false;
+            LogListenStateCpuTime("Paused");
+            Trace.TraceInformation("Recognition resumed");
+
+            // Thread-safe: if (recognitionStatus == STATUS_WAITING_DEVICE)
+            if (Interlocked.Read(ref recognitionStatus) == STATUS_WAITING_DEVICE) {
+                return; // started once the device is ready
+            }
+            try {
+                lock (DSN) {
+                    // Error is thrown if no grammars are loaded, StartSpeechRecognition() starts it then
+                    if (loadedGrammars.Count > 0 && Interlocked.Read(ref recognitionStatus) == STATUS_STOPPED) {
+                        this.DSN.RecognizeAsync(RecognizeMode.Multiple);
+                        // Thread-safe: recognitionStatus = STATUS_RECOGNIZING
+                        Interlocked.Exchange(ref recognitionStatus, STATUS_RECOGNIZING);
+                    }
+                }
+            } catch (Exception e) {
+                Trace.TraceError("Failed to resume phrase recognition due to exception");
+                Trace.TraceError(e.ToString());
+            }
+        }
+
+        private void LogListenStateCpuTime(string state) {
+            TimeSpan cpuTime = Process.GetCurrentProcess().TotalProcessorTime;
+            double seconds = listenStateWatch.Elapsed.TotalSeconds;
+            double cpuMilliseconds = (cpuTime - listenStateCpuTime).TotalMilliseconds;
+            Trace.TraceInformation("{0} for {1:0.0} s using {2:0} ms of CPU time ({3:0.0}% of one core)", state, seconds, cpuMilliseconds,
+                seconds > 0 ? cpuMilliseconds / 10 / seconds : 0);
+            listenStateWatch.Restart();
+            listenStateCpuTime = cpuTime;
+        }
+
+        private void SetGrammar(bool isDialogueMode, List<Grammar> grammars) {
             this.DSN.RequestRecognizerUpdate();
-            this.DSN.UnloadAllGrammars();
-            foreach (Grammar grammar in grammars) {
+            UpdateLoadedGrammars(isDialogueMode, grammars, new HashSet<Grammar>(grammars));
+        }
+
+        // Enable the grammars of the new mode and disable the others, the grammars of the other mode stay loaded
+        // and the ones of neither mode (an older dialogue) are unloaded.
+        private void ToggleGrammars(bool isDialogueMode, List<Grammar> grammars) {
+            HashSet<Grammar> kept = new HashSet<Grammar>(grammars);
+            kept.UnionWith(isDialogueMode ? commandModeGrammars : dialogueModeGrammars);
+            UpdateLoadedGrammars(isDialogueMode, grammars, kept);
+        }
+
+        // Only load the grammars that are not loaded yet and unload the loaded ones that are not `kept`,
+        // the kept grammars that are not in `grammars` are disabled.
+        // The providers return the same Grammar instances for unchanged phrases (see CommandList,
+        // FavoritesList and GrammarCache), so a favorites change does not reload the [ConsoleCommands] grammars.
+        private void UpdateLoadedGrammars(bool isDialogueMode, List<Grammar> grammars, HashSet<Grammar> kept) {
+            HashSet<Grammar> enabled = new HashSet<Grammar>(grammars);
+            List<Grammar> toLoad = grammars.Where((g) => !loadedGrammars.Contains(g)).Distinct().ToList();
+            List<Grammar> toUnload = loadedGrammars.Where((g) => !kept.Contains(g)).ToList();
+
+            BeginModeSwitch(isDialogueMode, toLoad, toUnload.Count, loadedGrammars.Count - toUnload.Count);
+            foreach (Grammar grammar in toUnload) {
+                this.DSN.UnloadGrammar(grammar);
+                loadedGrammars.Remove(grammar);
+            }
+            foreach (Grammar grammar in loadedGrammars) {
+                grammar.Enabled = enabled.Contains(grammar);
+            }
+            foreach (Grammar grammar in toLoad) {
+                grammar.Enabled = true;
                 this.DSN.LoadGrammarAsync(grammar);
+                loadedGrammars.Add(grammar);
+            }
+            SetModeGrammars(isDialogueMode, grammars);
+
+            if (toLoad.Count == 0) {
+                // Nothing to wait for but the recognizer applying the changes
+                object token;
+                lock (modeSwitchLock) {
+                    token = modeSwitchToken;
+                }
+                this.DSN.RequestRecognizerUpdate(token);
+            }
+        }
+
+        private void SetModeGrammars(bool isDialogueMode, List<Grammar> grammars) {
+            if (isDialogueMode) {
+                dialogueModeGrammars = grammars;
+            } else {
+                commandModeGrammars = grammars;
+            }
+        }
+
+        private void BeginModeSwitch(bool isDialogueMode, ICollection<Grammar> loads, int unloaded, int kept) {
+            lock (modeSwitchLock) {
+                modeSwitchWatch.Restart();
+                modeSwitchPendingLoads = new HashSet<Grammar>(loads);
+                modeSwitchToken = new object();
+                modeSwitchDescription = string.Format("{0} mode ({1}, {2} grammars loaded, {3} unloaded, {4} kept)",
+                    isDialogueMode ? "dialogue" : "command", toggleGrammars ? GRAMMAR_SWITCH_TOGGLE : GRAMMAR_SWITCH_RELOAD, loads.Count, unloaded, kept);
+            }
+        }
+
+        // Must be called with modeSwitchLock held
+        private void ReportModeSwitchIfDone() {
+            if (modeSwitchDescription != null && modeSwitchPendingLoads.Count == 0) {
+                long elapsed = modeSwitchWatch.ElapsedMilliseconds;
+                Trace.TraceInformation("Switched to {0} in {1} ms", modeSwitchDescription, elapsed);
+                modeSwitchDescription = null;
+                modeSwitchCount++;
+                modeSwitchTotalMilliseconds += elapsed;
+                modeSwitchMaxMilliseconds = Math.Max(modeSwitchMaxMilliseconds, elapsed);
+            }
+        }
+
+        // Log the average and maximum mode switch latency of the session, to compare grammarSwitchMode=reload
+        // and grammarSwitchMode=toggle on the same load order
+        public void LogModeSwitchSummary() {
+            lock (modeSwitchLock) {
+                Trace.TraceInformation("Mode switches ({0}): {1}, average {2} ms, max {3} ms", toggleGrammars ? GRAMMAR_SWITCH_TOGGLE : GRAMMAR_SWITCH_RELOAD,
+                    modeSwitchCount, modeSwitchCount > 0 ? modeSwitchTotalMilliseconds / modeSwitchCount : 0, modeSwitchMaxMilliseconds);
+            }
+        }
+
+        private void DSN_LoadGrammarCompleted(object sender, LoadGrammarCompletedEventArgs e) {
+            if (e.Error != null) {
+                Trace.TraceError("Failed to load grammar {0}: {1}", e.Grammar.Name, e.Error.ToString());
+            }
+            lock (modeSwitchLock) {
+                if (modeSwitchPendingLoads.Remove(e.Grammar)) {
+                    ReportModeSwitchIfDone();
+                }
+            }
+        }
+
+        private void DSN_RecognizerUpdateReached(object sender, RecognizerUpdateReachedEventArgs e) {
+            lock (modeSwitchLock) {
+                if (e.UserToken != null && e.UserToken == modeSwitchToken) {
+                    ReportModeSwitchIfDone();
+                }
             }
         }
 